@@ -8,7 +8,9 @@
 #include "BoardRepresentation/Pieces.h"
 #include "BoardRepresentation/Types.h"
 #include "BoardRepresentation/Zobrist.h"
+#include "Engine/Constants.h"
 #include "Engine/Move.h"
+#include "Engine/Nnue.h"
 #include "Engine/Undo.h"
 
 #define MAX_REVERSIBLE_MOVES 100
@@ -57,9 +59,11 @@ public:
 	inline Bitboard GetPieceBitboard(Piece p) const noexcept { return m_pieceBitboards[p]; }
 	inline const Bitboard* const GetPieceBitboards() const noexcept { return m_pieceBitboards.data(); }
 
-	Bitboard GetAllPieceBitboard() const;
-	Bitboard GetWhitePieceBitboard() const;
-	Bitboard GetBlackPieceBitboard() const;
+	// Kept up to date by PickUp and PutDown, so these are just loads.
+	inline Bitboard GetAllPieceBitboard() const noexcept { return m_allPieceBitboard; }
+	inline Bitboard GetWhitePieceBitboard() const noexcept { return m_colourBitboards[0]; }
+	inline Bitboard GetBlackPieceBitboard() const noexcept { return m_colourBitboards[1]; }
+	inline Bitboard GetColourBitboard(Colour colour) const noexcept { return m_colourBitboards[static_cast<size_t>(colour)]; }
 
 	Piece GetPieceAtSquare(Square square) const noexcept { return m_boardPieces[static_cast<size_t>(square)]; }
 
@@ -68,13 +72,14 @@ public:
 	inline bool GetCastlePermission(CastlePermission castlePermission) const noexcept { return m_castlePermissions & castlePermission;  }
 
 	inline void SetCastlePermission(CastlePermission castlePermission, bool permitted) noexcept { 
-		if (permitted)
-			m_castlePermissions |= castlePermission;
-		else
-			m_castlePermissions &= ~castlePermission;
+		if (GetCastlePermission(castlePermission) == permitted)
+			return;
+
+		m_castlePermissions ^= castlePermission;
+		m_zobrist.ApplyCastleHash(castlePermission);
 	 }
 
-	inline void SetCastlePermissions(uint8_t castlePermissions) noexcept { m_castlePermissions = castlePermissions; }
+	void SetCastlePermissions(uint8_t castlePermissions) noexcept;
 
 	inline Square GetEnPassantSquare() const noexcept { return m_enPassantSquare; }
 	void SetEnPassantSquare(Square square) noexcept;
@@ -83,29 +88,44 @@ public:
 	inline bool IsWhiteTurn() const noexcept { return m_isWhiteTurn; }
 	inline void SwitchTurn() noexcept { m_isWhiteTurn = !m_isWhiteTurn; m_zobrist.ApplyWhiteTurnHash(); }
 
+	// True if the position has been seen before since the last irreversible move.
 	bool IsRepeatPosition() const noexcept;
 
 	bool CheckQuietDraws() const noexcept;
 
 	inline int GetPhase() const noexcept { return (m_phase > START_PHASE) ? START_PHASE : m_phase; }
 
+	// White-relative material and piece-square sums, kept up to date by PickUp and PutDown.
+	inline int GetMidgameScore() const noexcept { return m_midgameScore; }
+	inline int GetEndgameScore() const noexcept { return m_endgameScore; }
+
+	// With a network set, PickUp and PutDown also keep its accumulator up to date. Pass nullptr to go back to the PSTs.
+	void SetNetwork(const NnueNetwork* network);
+	inline const NnueNetwork* GetNetwork() const noexcept { return m_network; }
+	inline const NnueAccumulator& GetAccumulator() const noexcept { return m_accumulator; }
+
 	inline Hash GetHash() const noexcept { return m_zobrist.GetHash(); }
 	void RebuildHash();
+	void RebuildAccumulator();
 
 	friend std::ostream& operator<<(std::ostream& os, const Board& board);
 
 private:
+	// MakeMove and UndoMove check the side to move once and hand over to these, so nothing below them branches on it.
+	template<Colour Us> Undo MakeMove(const Move& move);
+	template<Colour Us> void UndoMove(const Move& move, const Undo& undo);
+
 	void DoCapture(const Location& from, const Location& to, Undo& undo);
-	void DoEnPassantCapture(const Location& to);
-	void DoDoublePawnPush(const Location& to);
-	void MakeCastleMove(const Location& to);
-	void MakePromotionMove(const Location& from, const Location& to, Piece promotionPiece);
-	void MakeQuietMove(const Location& from, const Location& to, bool& isReversible);
+	template<Colour Us> void DoEnPassantCapture(const Location& to);
+	template<Colour Us> void DoDoublePawnPush(const Location& to);
+	template<Colour Us> void MakeCastleMove(const Location& to);
+	template<Colour Us> void MakePromotionMove(const Location& from, const Location& to, Piece promotionPiece);
+	template<Colour Us> void MakeQuietMove(const Location& from, const Location& to, bool& isReversible);
 
 	void UndoCapture(const Location& to, Piece capturedPiece);
-	void UndoEnPassantCapture(const Location& to);
-	void UndoCastleMove(const Location& to);
-	void UndoPromotionMove(const Location& from, const Location& to, Piece promotionPiece);
+	template<Colour Us> void UndoEnPassantCapture(const Location& to);
+	template<Colour Us> void UndoCastleMove(const Location& to);
+	template<Colour Us> void UndoPromotionMove(const Location& from, const Location& to, Piece promotionPiece);
 	void UndoNormalMove(const Location& from, const Location& to);
 
 	bool PickUp(Piece piece, const Location& loc);
@@ -128,7 +148,11 @@ private:
 	void CheckKingCount(const Move& move) const;
 #endif
 
+	inline static constexpr size_t GetColourIndex(Piece piece) noexcept { return (piece < Piece::BLACK_PAWN) ? 0 : 1; }
+
 	std::array<Bitboard, Piece::NUM_PIECES> 				m_pieceBitboards;
+	std::array<Bitboard, 2> 								m_colourBitboards;
+	Bitboard 												m_allPieceBitboard;
 	std::array<Piece, static_cast<size_t>(Square::COUNT)> 	m_boardPieces;
 
 	uint8_t 												m_castlePermissions;
@@ -143,6 +167,11 @@ private:
 	size_t 													m_repetitionStackTail;
 
 	int 													m_phase;
+	int 													m_midgameScore;
+	int 													m_endgameScore;
+
+	const NnueNetwork* 										m_network;
+	NnueAccumulator 										m_accumulator;
 
 	Zobrist 												m_zobrist;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Bitboard.h"
+#include "Types.h"
 
 
 #define PIECES_LIST 		\
@@ -137,4 +138,80 @@ constexpr Bitboard GetStartingWhitePiecesBitboard() {
 	#undef X
 
 	return bitboard;
- }
\ No newline at end of file
+ }
+
+// Everything about a side that move generation and making moves need, so that code templated on the
+// colour can be written once and still compile down to straight-line code for each side.
+template<Colour C>
+struct ColourTraits;
+
+template<>
+struct ColourTraits<Colour::WHITE> {
+	static constexpr Piece PAWN 								{ Piece::WHITE_PAWN };
+	static constexpr Piece KNIGHT 								{ Piece::WHITE_KNIGHT };
+	static constexpr Piece BISHOP 								{ Piece::WHITE_BISHOP };
+	static constexpr Piece ROOK 								{ Piece::WHITE_ROOK };
+	static constexpr Piece QUEEN 								{ Piece::WHITE_QUEEN };
+	static constexpr Piece KING 								{ Piece::WHITE_KING };
+
+	// Pawns on these ranks can push twice, or promote on their next move.
+	static constexpr uint64_t DOUBLE_PUSH_RANK_MASK 			{ RANK_2_MASK };
+	static constexpr uint64_t PROMOTION_RANK_MASK 				{ RANK_7_MASK };
+
+	static constexpr CastlePermission KINGSIDE 					{ CastlePermission::WHITE_KINGSIDE };
+	static constexpr CastlePermission QUEENSIDE 				{ CastlePermission::WHITE_QUEENSIDE };
+
+	static constexpr uint64_t KING_START_MASK 					{ E1_MASK };
+	static constexpr uint64_t KINGSIDE_ROOK_START_MASK 			{ H1_MASK };
+	static constexpr uint64_t QUEENSIDE_ROOK_START_MASK 		{ A1_MASK };
+
+	static constexpr Square KINGSIDE_CASTLE_SQUARE 				{ Square::g1 };
+	static constexpr Square QUEENSIDE_CASTLE_SQUARE 			{ Square::c1 };
+	static constexpr uint64_t KINGSIDE_KING_END_MASK 			{ G1_MASK };
+	static constexpr uint64_t QUEENSIDE_KING_END_MASK 			{ C1_MASK };
+	static constexpr uint64_t KINGSIDE_ROOK_END_MASK 			{ F1_MASK };
+	static constexpr uint64_t QUEENSIDE_ROOK_END_MASK 			{ D1_MASK };
+
+	static constexpr uint64_t KINGSIDE_CASTLE_SPACE_MASK 		{ WHITE_KINGSIDE_CASTLE_SPACE_MASK };
+	static constexpr uint64_t QUEENSIDE_CASTLE_SPACE_MASK 		{ WHITE_QUEENSIDE_CASTLE_SPACE_MASK };
+	static constexpr uint64_t KINGSIDE_CASTLE_CHECKS_MASK 		{ WHITE_KINGSIDE_CASTLE_CHECKS_MASK };
+	static constexpr uint64_t QUEENSIDE_CASTLE_CHECKS_MASK 		{ WHITE_QUEENSIDE_CASTLE_CHECKS_MASK };
+
+	static constexpr Bitboard ShiftForward(Bitboard bb) noexcept { return bb.ShiftNorth(); }
+	static constexpr Bitboard ShiftBackward(Bitboard bb) noexcept { return bb.ShiftSouth(); }
+};
+
+template<>
+struct ColourTraits<Colour::BLACK> {
+	static constexpr Piece PAWN 								{ Piece::BLACK_PAWN };
+	static constexpr Piece KNIGHT 								{ Piece::BLACK_KNIGHT };
+	static constexpr Piece BISHOP 								{ Piece::BLACK_BISHOP };
+	static constexpr Piece ROOK 								{ Piece::BLACK_ROOK };
+	static constexpr Piece QUEEN 								{ Piece::BLACK_QUEEN };
+	static constexpr Piece KING 								{ Piece::BLACK_KING };
+
+	static constexpr uint64_t DOUBLE_PUSH_RANK_MASK 			{ RANK_7_MASK };
+	static constexpr uint64_t PROMOTION_RANK_MASK 				{ RANK_2_MASK };
+
+	static constexpr CastlePermission KINGSIDE 					{ CastlePermission::BLACK_KINGSIDE };
+	static constexpr CastlePermission QUEENSIDE 				{ CastlePermission::BLACK_QUEENSIDE };
+
+	static constexpr uint64_t KING_START_MASK 					{ E8_MASK };
+	static constexpr uint64_t KINGSIDE_ROOK_START_MASK 			{ H8_MASK };
+	static constexpr uint64_t QUEENSIDE_ROOK_START_MASK 		{ A8_MASK };
+
+	static constexpr Square KINGSIDE_CASTLE_SQUARE 				{ Square::g8 };
+	static constexpr Square QUEENSIDE_CASTLE_SQUARE 			{ Square::c8 };
+	static constexpr uint64_t KINGSIDE_KING_END_MASK 			{ G8_MASK };
+	static constexpr uint64_t QUEENSIDE_KING_END_MASK 			{ C8_MASK };
+	static constexpr uint64_t KINGSIDE_ROOK_END_MASK 			{ F8_MASK };
+	static constexpr uint64_t QUEENSIDE_ROOK_END_MASK 			{ D8_MASK };
+
+	static constexpr uint64_t KINGSIDE_CASTLE_SPACE_MASK 		{ BLACK_KINGSIDE_CASTLE_SPACE_MASK };
+	static constexpr uint64_t QUEENSIDE_CASTLE_SPACE_MASK 		{ BLACK_QUEENSIDE_CASTLE_SPACE_MASK };
+	static constexpr uint64_t KINGSIDE_CASTLE_CHECKS_MASK 		{ BLACK_KINGSIDE_CASTLE_CHECKS_MASK };
+	static constexpr uint64_t QUEENSIDE_CASTLE_CHECKS_MASK 		{ BLACK_QUEENSIDE_CASTLE_CHECKS_MASK };
+
+	static constexpr Bitboard ShiftForward(Bitboard bb) noexcept { return bb.ShiftSouth(); }
+	static constexpr Bitboard ShiftBackward(Bitboard bb) noexcept { return bb.ShiftNorth(); }
+};
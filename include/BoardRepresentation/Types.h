@@ -13,4 +13,11 @@ enum CastlePermission : uint8_t {
 	WHITE_QUEENSIDE = 1 << 1,
 	BLACK_KINGSIDE 	= 1 << 2,
 	BLACK_QUEENSIDE = 1 << 3
-};
\ No newline at end of file
+};
+
+enum class Colour : uint8_t {
+	WHITE,
+	BLACK
+};
+
+constexpr Colour GetOtherColour(Colour colour) { return (colour == Colour::WHITE) ? Colour::BLACK : Colour::WHITE; }
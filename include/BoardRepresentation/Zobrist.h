@@ -29,8 +29,8 @@ public:
 private:
 	PieceHashValuesList 												m_pieceHashes;
 
-	// Castlehashes size is 8 so it's cleaner and easier to fid the hash for a permission
-	std::array<Hash, 8> 												m_castleHashes;
+	// Indexed by the permission's bit, so it needs room for index 8 (BLACK_QUEENSIDE).
+	std::array<Hash, 16> 												m_castleHashes;
 
 	std::array<Hash, static_cast<size_t>(Square::COUNT)> 				m_enPassantHashes;
 
@@ -2,4 +2,10 @@
 
 #define DEBUG 0
 
-#define TRANSPOSITION_TABLE_SIZE_MB 1024
\ No newline at end of file
+#define TRANSPOSITION_TABLE_SIZE_MB 1024
+#define MAX_TRANSPOSITION_TABLE_SIZE_MB 65536
+
+#define DEFAULT_THREADS 1
+#define MAX_THREADS 256
+
+#define DEFAULT_NNUE_FILE "knifefish.nnue"
\ No newline at end of file
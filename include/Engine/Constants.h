@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "BoardRepresentation/Pieces.h"
+#include "Engine/Move.h"
 
 using Clock = std::chrono::steady_clock;
 using Moment = Clock::time_point;
@@ -21,7 +22,7 @@ constexpr int SecsToMillisecs(double secs) { return round(secs * 1000.0); }
 #define NULL_MOVE_PRUNING_REDUCTION 4
 #define ASPIRATION_WINDOW_DELTA 25
 
-constexpr Move GARBAGE_MOVE{ 0, Square::NONE, Square::NONE };
+constexpr Move GARBAGE_MOVE{};
 
 constexpr int16_t NO_SCORE { 0 };
 constexpr int16_t DRAW_SCORE { 0 };
@@ -226,6 +227,24 @@ constexpr std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece:
 	BLACK_KING_EG_PST
 };
 
+// Folds the piece values into the piece-square tables, giving the white-relative score of a piece standing on a square.
+constexpr std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece::NUM_PIECES> CombinedPieceSquareTables(
+	const std::array<int, static_cast<size_t>(Piece::NUM_PIECES)>& pieceValues,
+	const std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece::NUM_PIECES>& psts
+) {
+	std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece::NUM_PIECES> combined;
+
+	for (size_t piece = 0; piece < Piece::NUM_PIECES; ++piece) {
+		for (size_t i = 0; i < static_cast<size_t>(Square::COUNT); ++i)
+			combined[piece][i] = pieceValues[piece] - psts[piece][i];
+	}
+
+	return combined;
+}
+
+constexpr std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece::NUM_PIECES> MG_PIECE_SQUARE_TABLES = CombinedPieceSquareTables(MG_PIECE_VALUES, MG_PST_LIST);
+constexpr std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, Piece::NUM_PIECES> EG_PIECE_SQUARE_TABLES = CombinedPieceSquareTables(EG_PIECE_VALUES, EG_PST_LIST);
+
 constexpr std::array<int, static_cast<size_t>(Square::COUNT)> KING_DEFENCE_PAWN_PST_PRE_FLIP {
 	  0,  0,  0,  0,  0,  0,  0,  0,
 	 25, 35, 10,  0,  0, 10, 35, 25,
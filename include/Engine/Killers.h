@@ -7,7 +7,7 @@
 class Killers {
 public:
 	inline constexpr Killers() noexcept : m_killers{} { Reset(); }
-	inline constexpr void Reset() noexcept { m_killers.fill(Move{ 0, Square::NONE, Square::NONE }); };
+	inline constexpr void Reset() noexcept { m_killers.fill(Move{}); };
 
 	inline const Move& GetFirst(int8_t depth) noexcept { return m_killers[FirstIndex(depth)]; }
 	inline const Move& GetSecond(int8_t depth) noexcept { return m_killers[SecondIndex(depth)]; }
@@ -2,11 +2,18 @@
 
 #include <array>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <string_view>
 #include <vector>
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 #include "BoardRepresentation/Bitboard.h"
 #include "BoardRepresentation/Square.h"
+#include "BoardRepresentation/Types.h"
 
 
 constexpr Bitboard FILE_A { 0x8080808080808080 };
@@ -38,10 +45,36 @@ constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> BLACK_KING_DE
 	0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 3ULL, 7ULL, 14ULL, 28ULL, 56ULL, 112ULL, 224ULL, 192ULL, 771ULL, 1799ULL, 3598ULL, 7196ULL, 14392ULL, 28784ULL, 57568ULL, 49344ULL, 197376ULL, 460544ULL, 921088ULL, 1842176ULL, 3684352ULL, 7368704ULL, 14737408ULL, 12632064ULL, 50528256ULL, 117899264ULL, 235798528ULL, 471597056ULL, 943194112ULL, 1886388224ULL, 3772776448ULL, 3233808384ULL, 12935233536ULL, 30182211584ULL, 60364423168ULL, 120728846336ULL, 241457692672ULL, 482915385344ULL, 965830770688ULL, 827854946304ULL, 3311419785216ULL, 7726646165504ULL, 15453292331008ULL, 30906584662016ULL, 61813169324032ULL, 123626338648064ULL, 247252677296128ULL, 211930866253824ULL, 847723465015296ULL, 1978021418369024ULL, 3956042836738048ULL, 7912085673476096ULL, 15824171346952192ULL, 31648342693904384ULL, 63296685387808768ULL, 54254301760978944ULL
 };
 
+// Each square only gets as many attack table entries as its occupancy mask has configurations, so the shift
+// differs from square to square and the tables for all squares are packed one after another.
+
+constexpr std::array<uint8_t, static_cast<size_t>(Square::COUNT)> GenerateMagicShifts(const std::array<Bitboard, static_cast<size_t>(Square::COUNT)>& occupancyMasks) {
+	std::array<uint8_t, static_cast<size_t>(Square::COUNT)> shifts{};
+	for (size_t i = 0; i < shifts.size(); ++i)
+		shifts[i] = 64 - occupancyMasks[i].PopCount();
+	return shifts;
+}
+
+constexpr std::array<size_t, static_cast<size_t>(Square::COUNT)> GenerateMagicOffsets(const std::array<Bitboard, static_cast<size_t>(Square::COUNT)>& occupancyMasks) {
+	std::array<size_t, static_cast<size_t>(Square::COUNT)> offsets{};
+	size_t offset = 0;
+	for (size_t i = 0; i < offsets.size(); ++i) {
+		offsets[i] = offset;
+		offset += 1ULL << occupancyMasks[i].PopCount();
+	}
+	return offsets;
+}
+
+constexpr size_t GetMagicTableSize(const std::array<Bitboard, static_cast<size_t>(Square::COUNT)>& occupancyMasks) {
+	size_t size = 0;
+	for (Bitboard occupancyMask : occupancyMasks)
+		size += 1ULL << occupancyMask.PopCount();
+	return size;
+}
+
 // Orthogonal stuff
 
 #define MAX_ORTHOGONAL_RELEVANT_BITS 12
-#define ORTHOGONAL_SHIFT (64 - MAX_ORTHOGONAL_RELEVANT_BITS)
 #define ORTHOGONAL_CONFIGURATIONS (1 << MAX_ORTHOGONAL_RELEVANT_BITS)
 
 constexpr std::array<Bitboard, 8> FILES = { FILE_A, FILE_B, FILE_C, FILE_D, FILE_E, FILE_F, FILE_G, FILE_H };
@@ -88,14 +121,17 @@ constexpr Bitboard GetOrthogonalOccupancyMask(Square square) {
 	return ORTHOGONAL_OCCUPANCY_MASKS[static_cast<size_t>(square)];
 }
 
+constexpr std::array<uint8_t, static_cast<size_t>(Square::COUNT)> ORTHOGONAL_SHIFTS { GenerateMagicShifts(ORTHOGONAL_OCCUPANCY_MASKS) };
+constexpr std::array<size_t, static_cast<size_t>(Square::COUNT)> ORTHOGONAL_OFFSETS { GenerateMagicOffsets(ORTHOGONAL_OCCUPANCY_MASKS) };
+constexpr size_t ORTHOGONAL_TABLE_SIZE { GetMagicTableSize(ORTHOGONAL_OCCUPANCY_MASKS) };
+
 constexpr std::array<uint64_t, static_cast<size_t>(Square::COUNT)> ORTHOGONAL_MAGICS {
-	9403516606337777698ULL, 9259436022746316928ULL, 9296555552813350976ULL, 580964455010144336ULL, 72066390281965643ULL, 1585284807049447429ULL, 9369741224036061192ULL, 360288521021689088ULL, 4612864696301682688ULL, 869339865770166080ULL, 4611729999433568312ULL, 2884608342553010320ULL, 9079767192076293ULL, 36100270108836352ULL, 18054066844602434ULL, 72339176389175750ULL, 9277468558701364512ULL, 19292048209322000ULL, 9009432656093256ULL, 1157568246904782976ULL, 81073727361777714ULL, 2378226196678443009ULL, 145346710088977204ULL, 35218734579776ULL, 9229054313098413121ULL, 9315731013656117504ULL, 2454501586836652544ULL, 3382106390790160ULL, 2537811383157264ULL, 613615502379486500ULL, 720611416809181192ULL, 2205465978949ULL, 18049588271255552ULL, 379437064970602754ULL, 9557764343548870690ULL, 144255934221324354ULL, 432504186362462336ULL, 18309067945017856ULL, 297522632386414616ULL, 2738751798817853696ULL, 291680094420731904ULL, 73183666012162048ULL, 9226896109061047296ULL, 4899920828060270594ULL, 4904446524287096834ULL, 6917533425696246306ULL, 4630087453636591712ULL, 594615889375076356ULL, 17729637580864ULL, 45044929809896512ULL, 11565459416096440452ULL, 35461398528200ULL, 1152930303652921476ULL, 432665041477632512ULL, 9223671112615854184ULL, 126101906803393024ULL, 1297318513404813889ULL, 114486832924690ULL, 585490011047069761ULL, 4755803817911649474ULL, 149533732372997ULL, 586031348456882306ULL, 143520895729956ULL, 13835903047164903714ULL
+	2485987133907534098ULL, 1459168770886062080ULL, 72075461638815752ULL, 324267971411447808ULL, 9367504852013548032ULL, 360296770577761280ULL, 180144534867411456ULL, 1224979526028640512ULL, 54324809034661888ULL, 4785216342196372ULL, 144255994292084736ULL, 141287512606720ULL, 4755941978359727106ULL, 72198340116480128ULL, 73183528875241473ULL, 2594636336963027969ULL, 288274906376831112ULL, 1157425379116326928ULL, 6377263099702943744ULL, 72567903879186ULL, 7133707307598219264ULL, 54325770050864128ULL, 9011597327467016ULL, 2199031669012ULL, 4576210346639488ULL, 35186527977472ULL, 596799526985015936ULL, 4625214411643551876ULL, 1179951900611838080ULL, 308500974669004928ULL, 5066558170794116ULL, 2324701836948291714ULL, 70370900049952ULL, 1180086313785761792ULL, 6926545302178504720ULL, 35253108345089ULL, 2306968943497117712ULL, 576742330409681920ULL, 792932610237048833ULL, 1152921781800014084ULL, 288371114713841704ULL, 70506451714048ULL, 35184640557184ULL, 1152939096927142016ULL, 9223653529145638929ULL, 2306124570090340418ULL, 577604250973241346ULL, 45036288340000769ULL, 72198606974681600ULL, 142940810781184ULL, 126524239217950848ULL, 17609502294272ULL, 4649966649686917248ULL, 1155314050499084416ULL, 4647723620397810688ULL, 4611686586503988736ULL, 36284958638210ULL, 6991979941206164739ULL, 163818473493926018ULL, 4661278395182112789ULL, 1189513941056750594ULL, 9370302043484848386ULL, 36591817911764994ULL, 2639998352442914ULL
 };
 
 // Diagonal stuff
 
 #define MAX_DIAGONAL_RELEVANT_BITS 11
-#define DIAGONAL_SHIFT (64 - MAX_DIAGONAL_RELEVANT_BITS)
 #define DIAGONAL_CONFIGURATIONS (1 << MAX_DIAGONAL_RELEVANT_BITS)
 
 constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> DIAGONAL_RAYS {
@@ -143,13 +179,84 @@ constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> DIAGONAL_OCCU
 };
 
 constexpr std::array<uint64_t, static_cast<size_t>(Square::COUNT)> DIAGONAL_MAGICS {
-	3386515187041792ULL, 143091139870848ULL, 5422615572369113088ULL, 4323784413709074432ULL, 567356615036928ULL, 3620911770454983220ULL, 324567586586239008ULL, 5188709755388203520ULL, 1152928239116157956ULL, 1770143906043822720ULL, 4613942363398865024ULL, 9019433418754ULL, 9556726388768113152ULL, 36028805715099651ULL, 18061283178841088ULL, 2386908389043087402ULL, 432363225687802096ULL, 562985127003977ULL, 18034498960885888ULL, 9009989106532864ULL, 105556069134419ULL, 9024791620096000ULL, 1143492638150656ULL, 2306010170565595136ULL, 1752463548866628608ULL, 59379000804352ULL, 292805455053848584ULL, 4521741838721026ULL, 1013450723442475009ULL, 5764651516392637440ULL, 93487084253282885ULL, 1161643174134784ULL, 36319070538174464ULL, 17609370240064ULL, 2305846892401131792ULL, 387595033379840ULL, 157907669166854148ULL, 292755966078748752ULL, 36899628498551296ULL, 108315099676606592ULL, 38298191199740931ULL, 1236264554778888192ULL, 144133884085305984ULL, 1441433360047013896ULL, 306825592886804512ULL, 597294350526840873ULL, 362544729618120720ULL, 4612882296415223874ULL, 2382474605988153344ULL, 189292094714680320ULL, 94865897738613313ULL, 594501573657493568ULL, 18313474265323552ULL, 10088204182038258048ULL, 18023195676379714ULL, 2315171270293995569ULL, 11538294263964500104ULL, 4611690554181420080ULL, 4611985094180360448ULL, 292839528929312800ULL, 18858866397217028ULL, 4648561714293427234ULL, 7007601329428758656ULL, 10396841352536019008ULL
+	22520206421139712ULL, 1732777568448446464ULL, 2261043665502210ULL, 4612816318630461440ULL, 299342040666624ULL, 9223946540807127264ULL, 145252117763408384ULL, 2884837175961337862ULL, 684552709907548290ULL, 1482212876763268ULL, 1441239893371002884ULL, 9264190602910629889ULL, 11529217253966905504ULL, 1442278399409652096ULL, 351282972141293623ULL, 441354964686672008ULL, 292737961560113421ULL, 9800976289975372808ULL, 587719820095527200ULL, 2342998944232013828ULL, 2306406251243831320ULL, 36310283001565201ULL, 10451737635627483652ULL, 1225016595890831904ULL, 9042521200133184ULL, 72418269553924096ULL, 9944106375762166288ULL, 289360674310652416ULL, 362821314420949009ULL, 184647861749944320ULL, 9148488663961728ULL, 1126484024886568ULL, 4938199479274178564ULL, 37157454312116224ULL, 144469506772177409ULL, 18016599681794176ULL, 1126999687168064ULL, 299071457755202ULL, 72695315089606660ULL, 2255108079555138ULL, 324839726585481216ULL, 9368073338188072960ULL, 2306406045134627334ULL, 83897410396357120ULL, 2306414897010839568ULL, 580550731760128ULL, 5638330005915200ULL, 325459875737856ULL, 2306442260776224640ULL, 35785736732804ULL, 441353865150857248ULL, 288239447668425216ULL, 137476972560ULL, 567365855216657ULL, 4773904202680864896ULL, 7502999196748775744ULL, 6917811054003097604ULL, 2739315590056445952ULL, 4613973175520235588ULL, 2821326848ULL, 1196337644195904ULL, 2307743105466630664ULL, 622632133988712520ULL, 4612847111367952512ULL
 };
 
 constexpr Bitboard GetDiagonalOccupancyMask(Square square) {
 	return DIAGONAL_OCCUPANCY_MASKS[static_cast<size_t>(square)];
 }
 
+constexpr std::array<uint8_t, static_cast<size_t>(Square::COUNT)> DIAGONAL_SHIFTS { GenerateMagicShifts(DIAGONAL_OCCUPANCY_MASKS) };
+constexpr std::array<size_t, static_cast<size_t>(Square::COUNT)> DIAGONAL_OFFSETS { GenerateMagicOffsets(DIAGONAL_OCCUPANCY_MASKS) };
+constexpr size_t DIAGONAL_TABLE_SIZE { GetMagicTableSize(DIAGONAL_OCCUPANCY_MASKS) };
+
+// Hyperbola quintessence stuff
+
+constexpr Bitboard GenerateDiagonalLineMask(Square square) {
+	Bitboard bb = Bitboard(square);
+	Bitboard lineMask{0ULL};
+	Bitboard shadow;
+
+	shadow = bb;
+	while (shadow.Any()) {
+		shadow = shadow.ShiftNorthEast();
+		lineMask |= shadow;
+	}
+
+	shadow = bb;
+	while (shadow.Any()) {
+		shadow = shadow.ShiftSouthWest();
+		lineMask |= shadow;
+	}
+
+	return lineMask;
+}
+
+constexpr Bitboard GenerateAntiDiagonalLineMask(Square square) {
+	Bitboard bb = Bitboard(square);
+	Bitboard lineMask{0ULL};
+	Bitboard shadow;
+
+	shadow = bb;
+	while (shadow.Any()) {
+		shadow = shadow.ShiftNorthWest();
+		lineMask |= shadow;
+	}
+
+	shadow = bb;
+	while (shadow.Any()) {
+		shadow = shadow.ShiftSouthEast();
+		lineMask |= shadow;
+	}
+
+	return lineMask;
+}
+
+// Every square on a line through the given square, not including the square itself.
+constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> FILE_LINE_MASKS {
+	#define X(square) (FILES[GetFile(Square::square)] & ~Bitboard(Square::square)),
+	SQUARE_LIST
+	#undef X
+};
+
+constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> RANK_LINE_MASKS {
+	#define X(square) (RANKS[GetRank(Square::square)] & ~Bitboard(Square::square)),
+	SQUARE_LIST
+	#undef X
+};
+
+constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> DIAGONAL_LINE_MASKS {
+	#define X(square) GenerateDiagonalLineMask(Square::square),
+	SQUARE_LIST
+	#undef X
+};
+
+constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> ANTI_DIAGONAL_LINE_MASKS {
+	#define X(square) GenerateAntiDiagonalLineMask(Square::square),
+	SQUARE_LIST
+	#undef X
+};
+
 // Knight stuff
 constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> KNIGHT_ATTACK_SETS {
 	132096ULL, 329728ULL, 659712ULL, 1319424ULL, 2638848ULL, 5277696ULL, 10489856ULL, 4202496ULL, 33816580ULL, 84410376ULL, 168886289ULL, 337772578ULL, 675545156ULL, 1351090312ULL, 2685403152ULL, 1075839008ULL, 8657044482ULL, 21609056261ULL, 43234889994ULL, 86469779988ULL, 172939559976ULL, 345879119952ULL, 687463207072ULL, 275414786112ULL, 2216203387392ULL, 5531918402816ULL, 11068131838464ULL, 22136263676928ULL, 44272527353856ULL, 88545054707712ULL, 175990581010432ULL, 70506185244672ULL, 567348067172352ULL, 1416171111120896ULL, 2833441750646784ULL, 5666883501293568ULL, 11333767002587136ULL, 22667534005174272ULL, 45053588738670592ULL, 18049583422636032ULL, 145241105196122112ULL, 362539804446949376ULL, 725361088165576704ULL, 1450722176331153408ULL, 2901444352662306816ULL, 5802888705324613632ULL, 11533718717099671552ULL, 4620693356194824192ULL, 288234782788157440ULL, 576469569871282176ULL, 1224997833292120064ULL, 2449995666584240128ULL, 4899991333168480256ULL, 9799982666336960512ULL, 1152939783987658752ULL, 2305878468463689728ULL, 1128098930098176ULL, 2257297371824128ULL, 4796069720358912ULL, 9592139440717824ULL, 19184278881435648ULL, 38368557762871296ULL, 4679521487814656ULL, 9077567998918656ULL
@@ -169,27 +276,83 @@ constexpr std::array<Bitboard, static_cast<size_t>(Square::COUNT)> BLACK_PAWN_AT
 	0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 2ULL, 5ULL, 10ULL, 20ULL, 40ULL, 80ULL, 160ULL, 64ULL, 512ULL, 1280ULL, 2560ULL, 5120ULL, 10240ULL, 20480ULL, 40960ULL, 16384ULL, 131072ULL, 327680ULL, 655360ULL, 1310720ULL, 2621440ULL, 5242880ULL, 10485760ULL, 4194304ULL, 33554432ULL, 83886080ULL, 167772160ULL, 335544320ULL, 671088640ULL, 1342177280ULL, 2684354560ULL, 1073741824ULL, 8589934592ULL, 21474836480ULL, 42949672960ULL, 85899345920ULL, 171798691840ULL, 343597383680ULL, 687194767360ULL, 274877906944ULL, 2199023255552ULL, 5497558138880ULL, 10995116277760ULL, 21990232555520ULL, 43980465111040ULL, 87960930222080ULL, 175921860444160ULL, 70368744177664ULL, 562949953421312ULL, 1407374883553280ULL, 2814749767106560ULL, 5629499534213120ULL, 11258999068426240ULL, 22517998136852480ULL, 45035996273704960ULL, 18014398509481984ULL
 };
 
+// How sliding piece attacks are looked up. Magics work everywhere, PEXT replaces the multiply and shift with a
+// single BMI2 instruction and hyperbola quintessence computes the attacks with no table at all.
+enum class SliderBackend : uint8_t {
+	MAGIC,
+	PEXT,
+	HYPERBOLA_QUINTESSENCE,
+	COUNT
+};
+
+constexpr std::array<std::string_view, static_cast<size_t>(SliderBackend::COUNT)> SLIDER_BACKEND_NAMES {
+	"magic", "pext", "hyperbola quintessence"
+};
+
+// The attack tables are several megabytes and never change once built, so there is a single copy for the whole
+// process. It is built the first time it is asked for and shared read-only by every move generator on every thread.
 class MagicBitboardHelper {
 public:
-	MagicBitboardHelper();
+	static const MagicBitboardHelper& GetInstance();
+
+	// A separate helper using the given backend, for comparing backends. Everything else should share GetInstance.
+	static std::unique_ptr<const MagicBitboardHelper> Create(SliderBackend sliderBackend);
+
+	static bool IsSliderBackendSupported(SliderBackend sliderBackend);
+
+	// The fastest supported backend on the CPU we're running on.
+	static SliderBackend GetBestSliderBackend();
+
+	inline SliderBackend GetSliderBackend() const noexcept { return m_sliderBackend; }
+
+	MagicBitboardHelper(const MagicBitboardHelper&) = delete;
+	MagicBitboardHelper& operator=(const MagicBitboardHelper&) = delete;
+
+	inline Bitboard GetOrthogonalAttacks(Square square, Bitboard configuration) const {
+		if (m_sliderBackend == SliderBackend::HYPERBOLA_QUINTESSENCE)
+			return GetOrthogonalHyperbolaAttacks(square, configuration);
+		return m_orthogonalAttacks[GetOrthogonalIndex(square, configuration)];
+	}
+
+	inline Bitboard GetDiagonalAttacks(Square square, Bitboard configuration) const {
+		if (m_sliderBackend == SliderBackend::HYPERBOLA_QUINTESSENCE)
+			return GetDiagonalHyperbolaAttacks(square, configuration);
+		return m_diagonalAttacks[GetDiagonalIndex(square, configuration)];
+	}
 
-	inline Bitboard GetOrthogonalAttacks(Square square, Bitboard configuration) const { return m_orthogonalAttacks[static_cast<size_t>(square)][GetOrthogonalIndex(square, configuration)]; }
-	inline Bitboard GetDiagonalAttacks(Square square, Bitboard configuration) const { return m_diagonalAttacks[static_cast<size_t>(square)][GetDiagonalIndex(square, configuration)]; }
 	inline Bitboard GetKnightAttacks(Square square) const { return KNIGHT_ATTACK_SETS[static_cast<size_t>(square)]; }
 	inline Bitboard GetKingAttacks(Square square) const { return KING_ATTACK_SETS[static_cast<size_t>(square)]; }
 	inline Bitboard GetWhitePawnAttacks(Square square) const { return WHITE_PAWN_ATTACK_SETS[static_cast<size_t>(square)]; }
 	inline Bitboard GetBlackPawnAttacks(Square square) const { return BLACK_PAWN_ATTACK_SETS[static_cast<size_t>(square)]; }
 
+	template<Colour C>
+	inline Bitboard GetPawnAttacks(Square square) const { return (C == Colour::WHITE) ? GetWhitePawnAttacks(square) : GetBlackPawnAttacks(square); }
+
 	inline Bitboard GetBetweenMask(Square square1, Square square2) const { return m_betweenMasks[static_cast<size_t>(square1)][static_cast<size_t>(square2)]; }
 
+	// The whole line from edge to edge through both squares, or nothing if they don't share one.
+	inline Bitboard GetLineMask(Square square1, Square square2) const { return m_lineMasks[static_cast<size_t>(square1)][static_cast<size_t>(square2)]; }
+
 	inline Bitboard GetOrthogonalRays(Square square) const { return ORTHOGONAL_RAYS[static_cast<size_t>(square)]; }
 	inline Bitboard GetDiagonalRays(Square square) const { return DIAGONAL_RAYS[static_cast<size_t>(square)]; }
 	inline Bitboard GetRays(Square square) const { return GetOrthogonalRays(square) | GetDiagonalRays(square); }
 
+	// Searches for a new set of magics and prints them as source, ready to replace ORTHOGONAL_MAGICS and DIAGONAL_MAGICS.
+	static void GenerateMagics();
+
 private:
+	MagicBitboardHelper(SliderBackend sliderBackend);
+
+#if defined(__BMI2__)
+	inline static uint64_t ParallelBitExtract(uint64_t value, uint64_t mask) { return _pext_u64(value, mask); }
+#else
+	// Without -mbmi2 the instruction can only be reached through a call to a function built for BMI2.
+	static uint64_t ParallelBitExtract(uint64_t value, uint64_t mask);
+#endif
+
 	inline uint64_t GenerateMagic() { return m_rng() & m_rng() & m_rng(); }
 
-	// Between masks
+	// Between and line masks
 
 	void PopulateBetweenMasks(Square square);
 	void PopulateBetweenMasks();
@@ -201,8 +364,11 @@ private:
 	// Orthogonal stuff
 
 	inline size_t GetOrthogonalIndex(Square square, Bitboard occupancy) const {
+		if (m_sliderBackend == SliderBackend::PEXT)
+			return ORTHOGONAL_OFFSETS[static_cast<size_t>(square)] + ParallelBitExtract(occupancy.GetBoard(), ORTHOGONAL_OCCUPANCY_MASKS[static_cast<size_t>(square)].GetBoard());
+
 		size_t magic = ORTHOGONAL_MAGICS[static_cast<size_t>(square)];
-		return (occupancy * magic) >> ORTHOGONAL_SHIFT;
+		return ORTHOGONAL_OFFSETS[static_cast<size_t>(square)] + ((occupancy * magic) >> ORTHOGONAL_SHIFTS[static_cast<size_t>(square)]);
 	}
 
 	void GenerateOrthogonalRays(Square square);
@@ -211,8 +377,8 @@ private:
 	Bitboard GenerateOrthogonalAttacks(Square square, Bitboard occupancy);
 	void GenerateOrthogonalOccupanciesAndAttacks(Square square, std::vector<Bitboard>& occupancies, std::vector<Bitboard>& attackSets);
 
-	uint64_t SearchForOrthogonalMagic(const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets);
-	void GenerateOrthogonalMagic(Square square);
+	uint64_t SearchForOrthogonalMagic(Square square, const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets);
+	uint64_t GenerateOrthogonalMagic(Square square);
 	void GenerateOrthogonalMagics();
 
 	void PopulateOrthogonalAttacks(Square square);
@@ -222,8 +388,11 @@ private:
 	// Diagonal stuff
 
 	inline size_t GetDiagonalIndex(Square square, Bitboard occupancy) const {
+		if (m_sliderBackend == SliderBackend::PEXT)
+			return DIAGONAL_OFFSETS[static_cast<size_t>(square)] + ParallelBitExtract(occupancy.GetBoard(), DIAGONAL_OCCUPANCY_MASKS[static_cast<size_t>(square)].GetBoard());
+
 		size_t magic = DIAGONAL_MAGICS[static_cast<size_t>(square)];
-		return (occupancy * magic) >> DIAGONAL_SHIFT;
+		return DIAGONAL_OFFSETS[static_cast<size_t>(square)] + ((occupancy * magic) >> DIAGONAL_SHIFTS[static_cast<size_t>(square)]);
 	}
 
 	void GenerateDiagonalRays(Square square);
@@ -232,13 +401,49 @@ private:
 	Bitboard GenerateDiagonalAttacks(Square square, Bitboard occupancy);
 	void GenerateDiagonalOccupanciesAndAttacks(Square square, std::vector<Bitboard>& occupancies, std::vector<Bitboard>& attackSets);
 
-	uint64_t SearchForDiagonalMagic(const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets);
-	void GenerateDiagonalMagic(Square square);
+	uint64_t SearchForDiagonalMagic(Square square, const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets);
+	uint64_t GenerateDiagonalMagic(Square square);
 	void GenerateDiagonalMagics();
 
 	void PopulateDiagonalAttacks(Square square);
 	void PopulateDiagonalAttacks();
 
+	// Hyperbola quintessence stuff
+
+	inline static uint64_t ReverseBits(uint64_t bb) {
+		bb = ((bb >> 1) & 0x5555555555555555ULL) | ((bb & 0x5555555555555555ULL) << 1);
+		bb = ((bb >> 2) & 0x3333333333333333ULL) | ((bb & 0x3333333333333333ULL) << 2);
+		bb = ((bb >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((bb & 0x0F0F0F0F0F0F0F0FULL) << 4);
+		return __builtin_bswap64(bb);
+	}
+
+	// o ^ (o - 2r) gives the attacks in the direction of the higher bits, and doing the same on the reversed board
+	// gives the other direction. Files and diagonals have one square per rank, so a byte swap is enough to reverse
+	// them, but a rank has to have its bits fully reversed.
+	template<bool IsRank>
+	inline static uint64_t GetLineAttacks(uint64_t occupancy, uint64_t lineMask, uint64_t squareBB) {
+		uint64_t forward = occupancy & lineMask;
+		uint64_t reverse = IsRank ? ReverseBits(forward) : __builtin_bswap64(forward);
+
+		forward -= squareBB;
+		reverse -= IsRank ? ReverseBits(squareBB) : __builtin_bswap64(squareBB);
+
+		forward ^= IsRank ? ReverseBits(reverse) : __builtin_bswap64(reverse);
+		return forward & lineMask;
+	}
+
+	inline static Bitboard GetOrthogonalHyperbolaAttacks(Square square, Bitboard occupancy) {
+		size_t index = static_cast<size_t>(square);
+		uint64_t squareBB = Bitboard(square).GetBoard();
+		return Bitboard(GetLineAttacks<false>(occupancy.GetBoard(), FILE_LINE_MASKS[index].GetBoard(), squareBB) | GetLineAttacks<true>(occupancy.GetBoard(), RANK_LINE_MASKS[index].GetBoard(), squareBB));
+	}
+
+	inline static Bitboard GetDiagonalHyperbolaAttacks(Square square, Bitboard occupancy) {
+		size_t index = static_cast<size_t>(square);
+		uint64_t squareBB = Bitboard(square).GetBoard();
+		return Bitboard(GetLineAttacks<false>(occupancy.GetBoard(), DIAGONAL_LINE_MASKS[index].GetBoard(), squareBB) | GetLineAttacks<false>(occupancy.GetBoard(), ANTI_DIAGONAL_LINE_MASKS[index].GetBoard(), squareBB));
+	}
+
 	// Knight stuff
 	void GenerateKnightAttacks(Square square);
 	void GenerateKnightAttacks();
@@ -253,10 +458,13 @@ private:
 	void GenerateBlackPawnAttacks(Square square);
 	void GenerateBlackPawnAttacks();
 
+	SliderBackend m_sliderBackend;
+
 	std::mt19937_64 m_rng;
 
-	std::array<std::array<Bitboard, ORTHOGONAL_CONFIGURATIONS>, static_cast<size_t>(Square::COUNT)> m_orthogonalAttacks;
-	std::array<std::array<Bitboard, DIAGONAL_CONFIGURATIONS>, static_cast<size_t>(Square::COUNT)> m_diagonalAttacks;
+	std::array<Bitboard, ORTHOGONAL_TABLE_SIZE> m_orthogonalAttacks;
+	std::array<Bitboard, DIAGONAL_TABLE_SIZE> m_diagonalAttacks;
 
 	std::array<std::array<Bitboard, static_cast<size_t>(Square::COUNT)>, static_cast<size_t>(Square::COUNT)> m_betweenMasks;
+	std::array<std::array<Bitboard, static_cast<size_t>(Square::COUNT)>, static_cast<size_t>(Square::COUNT)> m_lineMasks;
 };
\ No newline at end of file
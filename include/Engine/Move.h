@@ -7,27 +7,82 @@
 #include "BoardRepresentation/Pieces.h"
 
 
-struct Move {
-	int			m_score;
-	Square		m_from;
-	Square		m_to;
-	Piece		m_promotionPiece;
-	bool 		m_isCapture;
-	bool		m_isDoublePawnPush;
-	bool		m_isEnPassant;
-	bool		m_isCastle;
-
-	inline bool operator==(const Move& rhs) const noexcept {
-		return m_from == rhs.m_from
-			&& m_to == rhs.m_to
-			&& m_promotionPiece == rhs.m_promotionPiece
-			&& m_isCapture == rhs.m_isCapture
-			&& m_isDoublePawnPush == rhs.m_isDoublePawnPush
-			&& m_isEnPassant == rhs.m_isEnPassant
-			&& m_isCastle == rhs.m_isCastle;
+// The 4 flag bits of a packed move. Bit 2 marks a capture and bit 3 a promotion, with the low
+// two bits of a promotion giving the piece (knight, bishop, rook, queen).
+enum class MoveFlag : uint8_t {
+	QUIET 						= 0b0000,
+	DOUBLE_PAWN_PUSH 			= 0b0001,
+	CASTLE 						= 0b0010,
+	CAPTURE 					= 0b0100,
+	EN_PASSANT 					= 0b0101,
+	KNIGHT_PROMOTION 			= 0b1000,
+	BISHOP_PROMOTION 			= 0b1001,
+	ROOK_PROMOTION 				= 0b1010,
+	QUEEN_PROMOTION 			= 0b1011,
+	KNIGHT_PROMOTION_CAPTURE 	= 0b1100,
+	BISHOP_PROMOTION_CAPTURE 	= 0b1101,
+	ROOK_PROMOTION_CAPTURE 		= 0b1110,
+	QUEEN_PROMOTION_CAPTURE 	= 0b1111
+};
+
+#define MOVE_CAPTURE_FLAG_BIT 0b0100
+#define MOVE_PROMOTION_FLAG_BIT 0b1000
+
+// Bit n is set when n is one of the MoveFlag values. 0b0011, 0b0110 and 0b0111 are unused.
+#define MOVE_VALID_FLAGS_MASK 0b1111'1111'0011'0111
+
+// A move packed into 16 bits: bits 0-5 are the from square, bits 6-11 the to square and bits 12-15 the MoveFlag.
+// The promotion piece is stored without a colour, which is always that of the side making the move.
+// Move ordering scores are not part of the move; they are kept alongside it in the MoveList.
+// All zeros (h1h1) can never be a legal move, so it is used as the null move.
+class Move {
+public:
+	inline constexpr Move() noexcept : m_data{0} {}
+
+	inline constexpr Move(Square from, Square to, MoveFlag flag = MoveFlag::QUIET) noexcept :
+		m_data{ static_cast<uint16_t>(static_cast<uint16_t>(from) | (static_cast<uint16_t>(to) << 6) | (static_cast<uint16_t>(flag) << 12)) }
+	{}
+
+	// promotionPiece may be of either colour.
+	inline constexpr Move(Square from, Square to, Piece promotionPiece, bool isCapture) noexcept :
+		Move(from, to, static_cast<MoveFlag>(MOVE_PROMOTION_FLAG_BIT | (isCapture ? MOVE_CAPTURE_FLAG_BIT : 0) | ((promotionPiece % Piece::BLACK_PAWN) - Piece::WHITE_KNIGHT)))
+	{}
+
+	inline constexpr Square GetFrom() const noexcept { return static_cast<Square>(m_data & 0x3F); }
+	inline constexpr Square GetTo() const noexcept { return static_cast<Square>((m_data >> 6) & 0x3F); }
+	inline constexpr MoveFlag GetFlag() const noexcept { return static_cast<MoveFlag>(m_data >> 12); }
+
+	inline constexpr bool IsNull() const noexcept { return m_data == 0; }
+
+	// False for a move read back from somewhere it may have been corrupted, such as the TT, with a flag no move can have.
+	inline constexpr bool HasValidFlag() const noexcept { return (MOVE_VALID_FLAGS_MASK >> (m_data >> 12)) & 1; }
+
+	// True for en passant as well as ordinary and promoting captures.
+	inline constexpr bool IsCapture() const noexcept { return (m_data >> 12) & MOVE_CAPTURE_FLAG_BIT; }
+	inline constexpr bool IsPromotion() const noexcept { return (m_data >> 12) & MOVE_PROMOTION_FLAG_BIT; }
+	inline constexpr bool IsDoublePawnPush() const noexcept { return GetFlag() == MoveFlag::DOUBLE_PAWN_PUSH; }
+	inline constexpr bool IsEnPassant() const noexcept { return GetFlag() == MoveFlag::EN_PASSANT; }
+	inline constexpr bool IsCastle() const noexcept { return GetFlag() == MoveFlag::CASTLE; }
+
+	inline constexpr Piece GetPromotionPiece(bool isWhiteTurn) const noexcept {
+		if (!IsPromotion())
+			return Piece::EMPTY;
+
+		Piece whitePiece = static_cast<Piece>(Piece::WHITE_KNIGHT + ((m_data >> 12) & 0b11));
+		return isWhiteTurn ? whitePiece : static_cast<Piece>(whitePiece + Piece::BLACK_PAWN);
 	}
 
+	inline constexpr uint16_t GetData() const noexcept { return m_data; }
+
+	inline constexpr bool operator==(const Move& rhs) const noexcept { return m_data == rhs.m_data; }
+	inline constexpr bool operator!=(const Move& rhs) const noexcept { return m_data != rhs.m_data; }
+
 	std::string ToString() const;
+
+private:
+	uint16_t m_data;
 };
 
+static_assert(sizeof(Move) == 2);
+
 std::ostream& operator<<(std::ostream& os, Move move);
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 
 #include "BoardRepresentation/Board.h"
@@ -17,11 +18,13 @@
 constexpr std::array<int, 12> ABSOLUTE_PIECE_VALUES = { 100, 320, 330, 500, 900, 10000, 100, 320, 330, 500, 900, 10000 };
 
 
+// Each move's ordering score is kept in a parallel array rather than in the move itself,
+// so that the moves stay 16 bits wherever they are stored outside of a list.
 class MoveList {
 public:
 	static constexpr size_t MAX_POSSIBLE_MOVES = 218;
 
-	inline MoveList() : m_moveList{}, m_numMoves{0} {}
+	inline MoveList() : m_numMoves{0} {}
 
 	Move* begin() 	{ return m_moveList.data(); }
 	Move* end() 	{ return m_moveList.data() + m_numMoves; }
@@ -36,10 +39,13 @@ public:
 
 	inline void clear() { m_numMoves = 0; }
 
-	inline void push_back(const Move& move) { m_moveList[m_numMoves++] = move; }
+	inline int GetScore(size_t i) const { return m_scores[i]; }
+
+	inline void push_back(const Move& move, int score) { m_scores[m_numMoves] = score; m_moveList[m_numMoves++] = move; }
 
 private:
 	std::array<Move, MAX_POSSIBLE_MOVES> m_moveList;
+	std::array<int, MAX_POSSIBLE_MOVES> m_scores;
 	size_t m_numMoves;
 };
 
@@ -64,15 +70,37 @@ struct MoveGenerationContext {
 	Bitboard 													m_allPieceBB;
 	Bitboard 													m_emptySquareBB;
 	Bitboard 													m_enemyPieceBB;
-	Bitboard 													m_enemyAttackSet;
 	Bitboard 													m_checkMaskBB;
-	std::array<Bitboard, static_cast<size_t>(Square::COUNT)> 	m_pinMasks;
 	Bitboard													m_checkerBB;
+
+	// Friendly pieces that may only move along the line between their king and the slider pinning them.
+	Bitboard													m_pinnedBB;
+
+	// The check mask and pinned pieces are only worked out the first time they are needed.
+	bool														m_areMasksSet;
+
+	// The squares each of our piece types (pawn first) would check the enemy king from, and our pieces that would uncover
+	// a check from one of our sliders by moving off its line. Like the masks, these wait until something asks for them.
+	std::array<Bitboard, Piece::NUM_PIECES / 2>					m_checkSquaresBB;
+	Bitboard													m_discoveredCheckersBB;
+	bool														m_isCheckInfoSet;
+};
+
+// Captures include en passant and capturing promotions. Everything else, including quiet promotions and castling, is quiet.
+enum class MoveGenerationType : uint8_t {
+	ALL,
+	CAPTURES,
+	QUIETS
 };
 
 struct MoveGenerationParameters {
 	MoveList&													m_moves;
-	bool														m_capturesOnly;
+	MoveGenerationType											m_type;
+
+	inline bool IncludesCaptures() const noexcept { return m_type != MoveGenerationType::QUIETS; }
+	inline bool IncludesQuiets() const noexcept { return m_type != MoveGenerationType::CAPTURES; }
+
+	inline Bitboard GetCaptureMask() const noexcept { return IncludesCaptures() ? FULL_BOARD : EMPTY_BOARD; }
 };
 
 class MoveGenerator {
@@ -84,17 +112,47 @@ public:
 	bool GenerateMoves(const MoveGenerationParameters& params) const;
 	bool GenerateMoves(const MoveGenerationParameters& params, MoveGenerationContext& context) const;
 
-	Bitboard GetAttackSet(Bitboard pawnBB, Bitboard knightBB, Bitboard bishopBB, Bitboard rookBB, Bitboard queenBB, Bitboard kingBB, Bitboard emptySquareBB, Bitboard allPieceBB) const;
+	// For moves from somewhere other than the generator, such as the TT or the killers. A pseudo-legal move is one the
+	// generator could produce if it ignored pins and checks; IsLegal then only has to ask about those, and so should
+	// only be given moves that are already known to be pseudo-legal. Neither generates any moves.
+	bool IsPseudoLegal(const Move& move, const MoveGenerationContext& context) const;
+	bool IsLegal(const Move& move, MoveGenerationContext& context) const;
 
 	bool IsCheck() const;
 	bool IsCheck(const MoveGenerationContext& context) const;
 
+	// Whether a legal move would put the opponent in check, worked out without making it.
+	bool GivesCheck(const Move& move, MoveGenerationContext& context) const;
+
 	bool IsZugzwangLikely(const MoveGenerationContext& context) const;
 
+	// The material the side to move expects to win (or lose, if negative) by playing this capture,
+	// once all the recaptures on its to square have been played out cheapest attacker first. Pins are ignored.
+	int StaticExchangeEvaluation(const Move& move) const;
+
 private:
-	void GeneratePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
-	void GenerateWhitePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
-	void GenerateBlackPawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
+	// The public functions check the side to move once and hand over to these, so everything below runs without
+	// branching on it.
+	template<Colour Us> MoveGenerationContext GetMoveGenerationContext() const;
+	template<Colour Us> bool GenerateMoves(const MoveGenerationParameters& params, MoveGenerationContext& context) const;
+	template<Colour Us> bool IsPseudoLegal(const Move& move, const MoveGenerationContext& context) const;
+	template<Colour Us> bool IsLegal(const Move& move, MoveGenerationContext& context) const;
+	template<Colour Us> bool GivesCheck(const Move& move, MoveGenerationContext& context) const;
+
+	void SetCheckAndPinMasks(MoveGenerationContext& context) const;
+	template<Colour Us> void SetCheckInfo(MoveGenerationContext& context) const;
+
+	// The squares a piece on this square is allowed to move to without leaving its king in check through a pin.
+	inline Bitboard GetPinMask(const MoveGenerationContext& context, Square square) const {
+		return (context.m_pinnedBB & Bitboard{square}).Any() ? m_magicBitboardHelper.GetLineMask(context.m_friendlyKingSquare, square) : FULL_BOARD;
+	}
+
+	// Whether the enemy attacks a square, with sliders seeing through anything not in occupancy. This stands in for a
+	// full enemy attack set, since only the few squares the king could step to are ever asked about.
+	template<Colour Us> bool IsAttackedByEnemy(const MoveGenerationContext& context, Square square, Bitboard occupancy) const;
+	template<Colour Us> bool IsAnyAttackedByEnemy(const MoveGenerationContext& context, Bitboard squares) const;
+
+	template<Colour Us> void GeneratePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
 
 	void GenerateKnightMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
 
@@ -104,20 +162,16 @@ private:
 
 	void GenerateQueenMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
 
-	void GenerateKingMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
+	template<Colour Us> void GenerateKingMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
+
+	template<Colour Us> void GenerateCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
 
-	void GenerateCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
-	void GenerateWhiteCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
-	void GenerateBlackCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
+	// With a single checker, only king moves, captures of the checker and blocks between it and the king.
+	template<Colour Us> void GenerateEvasions(const MoveGenerationParameters& params, const MoveGenerationContext& context) const;
 
-	Bitboard GetWhitePawnAttackSet(Bitboard pawns) const;
-	Bitboard GetBlackPawnAttackSet(Bitboard pawns) const;
-	Bitboard GetKnightAttackSet(Bitboard knights) const;
-	Bitboard GetBishopAttackSet(Bitboard bishops, Bitboard allPieces) const;
-	Bitboard GetRookAttackSet(Bitboard rooks, Bitboard allPieces) const;
-	Bitboard GetQueenAttackSet(Bitboard queens, Bitboard allPieces) const;
-	Bitboard GetKingAttackSet(Bitboard king) const;
+	// Pieces of both colours attacking a square, with sliders seeing through anything not in occupancy.
+	Bitboard GetAttackersTo(Square square, Bitboard occupancy) const;
 
 	Board& m_board;
-	const MagicBitboardHelper m_magicBitboardHelper;
+	const MagicBitboardHelper& m_magicBitboardHelper;
 };
\ No newline at end of file
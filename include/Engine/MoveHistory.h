@@ -33,14 +33,14 @@ inline MoveHistory::MoveHistory() :
 }
 
 inline void MoveHistory::Adjust(bool isWhiteTurn, const Move& move, int16_t amount) noexcept {
-	int16_t& score = m_history[isWhiteTurn ? 0 : 1][static_cast<size_t>(move.m_from)][static_cast<size_t>(move.m_to)];
+	int16_t& score = m_history[isWhiteTurn ? 0 : 1][static_cast<size_t>(move.GetFrom())][static_cast<size_t>(move.GetTo())];
 	score += amount;
 	if (score >= MAX_HISTORY or score <= -MAX_HISTORY)
 		Decay();
 }
 
 inline int16_t MoveHistory::Get(bool isWhiteTurn, const Move& move) const noexcept {
-	return m_history[isWhiteTurn ? 0 : 1][static_cast<size_t>(move.m_from)][static_cast<size_t>(move.m_to)];
+	return m_history[isWhiteTurn ? 0 : 1][static_cast<size_t>(move.GetFrom())][static_cast<size_t>(move.GetTo())];
 }
 
 inline void MoveHistory::Decay() noexcept {
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Engine/Move.h"
+#include "Engine/MoveGenerator.h"
+#include "Engine/MoveHistory.h"
+
+
+enum class MovePickerStage : uint8_t {
+	TT_MOVE,
+	GENERATE_CAPTURES,
+	GOOD_CAPTURES,
+	FIRST_KILLER,
+	SECOND_KILLER,
+	GENERATE_QUIETS,
+	QUIETS,
+	BAD_CAPTURES,
+	DONE
+};
+
+// Hands out the moves of a position one at a time, best first, generating them in stages so that
+// a cutoff early on saves generating (and scoring) the rest. The order is the TT move, captures by
+// MVV-LVA that don't lose material by SEE, the killers, the rest of the quiets by history, and finally
+// the losing captures. The TT move and killers are checked on their own, so a cutoff from one of them
+// means that no quiets get generated at all.
+class MovePicker {
+public:
+	MovePicker(const MoveGenerator& moveGenerator, MoveGenerationContext& context, const Move& ttMove, const Move& firstKiller, const Move& secondKiller, const MoveHistory& moveHistory, bool isWhiteTurn);
+
+	// Returns false once there are no moves left.
+	bool Next(Move& move);
+
+	inline MovePickerStage GetStage() const noexcept { return m_stage; }
+
+private:
+	bool PickBest(Move& move);
+
+	// A move from outside the generator, good to play as long as it hasn't been tried already.
+	bool IsUsableKiller(const Move& killer) const;
+
+	const MoveGenerator& 							m_moveGenerator;
+	MoveGenerationContext& 							m_context;
+
+	Move 											m_ttMove;
+	Move 											m_firstKiller;
+	Move 											m_secondKiller;
+
+	const MoveHistory& 								m_moveHistory;
+	bool 											m_isWhiteTurn;
+
+	MovePickerStage 								m_stage;
+
+	MoveList 										m_moves;
+	std::array<int, MoveList::MAX_POSSIBLE_MOVES> 	m_scores;
+	size_t 											m_index;
+
+	MoveList 										m_badCaptures;
+	size_t 											m_badCaptureIndex;
+};
\ No newline at end of file
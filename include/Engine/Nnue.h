@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "BoardRepresentation/Pieces.h"
+#include "BoardRepresentation/Square.h"
+
+#define NNUE_INPUT_SIZE 768
+#define NNUE_HIDDEN_SIZE 256
+
+// Quantisation of the hidden layer (QA) and output weights (QB), and the scale from network output to centipawns.
+// The hidden layer is a plain clipped ReLU, so the output sum and the output bias are both quantised at QA * QB.
+#define NNUE_QA 255
+#define NNUE_QB 64
+#define NNUE_SCALE 400
+
+// The hidden layer for both sides of the board, kept up to date by the board as pieces are picked up and put down.
+// Index 0 is white's point of view and index 1 black's.
+struct NnueAccumulator {
+	alignas(32) std::array<std::array<int16_t, NNUE_HIDDEN_SIZE>, 2> m_values;
+};
+
+// A (768 -> 256) x 2 -> 1 network with a clipped ReLU. Each input is a piece on a square, seen from the point of view
+// of one side: the side is mirrored so that "our" pieces are always the first six and our back rank is always rank 1.
+//
+// The weights file is raw little-endian int16s in this order: the input weights (768 rows of 256, with row
+// piece * 64 + square using this engine's Piece and Square numbering, so h1 is square 0), the 256 hidden biases,
+// the 512 output weights (side to move first) and the output bias. The eval in centipawns is then
+// (sum of clamp(hidden, 0, QA) * output weight + output bias) * SCALE / (QA * QB).
+class NnueNetwork {
+public:
+	NnueNetwork();
+
+	bool Load(const std::string& path);
+	// The name is only used in the log.
+	bool Load(std::istream& stream, const std::string& name);
+	inline bool IsLoaded() const noexcept { return m_isLoaded; }
+
+	void ResetAccumulator(NnueAccumulator& accumulator) const;
+	void AddPiece(NnueAccumulator& accumulator, Piece piece, Square square) const;
+	void RemovePiece(NnueAccumulator& accumulator, Piece piece, Square square) const;
+
+	// The score in centipawns from the side to move's point of view.
+	int Evaluate(const NnueAccumulator& accumulator, bool isWhiteTurn) const;
+
+private:
+	inline static size_t GetWhiteFeature(Piece piece, Square square) noexcept { return piece * static_cast<size_t>(Square::COUNT) + static_cast<size_t>(square); }
+	inline static size_t GetBlackFeature(Piece piece, Square square) noexcept { return ((piece + Piece::BLACK_PAWN) % Piece::NUM_PIECES) * static_cast<size_t>(Square::COUNT) + (static_cast<size_t>(square) ^ 56); }
+
+	std::vector<int16_t> 								m_inputWeights;
+	std::array<int16_t, NNUE_HIDDEN_SIZE> 				m_inputBiases;
+	std::array<int16_t, 2 * NNUE_HIDDEN_SIZE> 			m_outputWeights;
+	int16_t 											m_outputBias;
+
+	bool 												m_isLoaded;
+};
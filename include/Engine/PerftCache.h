@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "BoardRepresentation/Zobrist.h"
+
+#define PERFT_CACHE_DEPTH_BITS 8
+#define PERFT_CACHE_DEPTH_MASK ((1ULL << PERFT_CACHE_DEPTH_BITS) - 1)
+
+// The count and depth are packed into one word, and the key is stored XORed with it. A torn entry written by
+// two threads at once then fails the key check instead of handing back a count for the wrong position or depth.
+struct PerftCacheEntry {
+	std::atomic<uint64_t> m_keyXorData;
+	std::atomic<uint64_t> m_data;
+};
+
+// Each position hashes to a pair of entries: the first keeps the deepest subtree seen and the second always takes the latest.
+struct PerftCacheBucket {
+	PerftCacheEntry m_deepest;
+	PerftCacheEntry m_latest;
+};
+
+struct PerftStatistics {
+	uint64_t m_cacheProbes;
+	uint64_t m_cacheHits;
+};
+
+// Subtree counts for perft, shared lock-free between the perft threads.
+class PerftCache {
+public:
+	PerftCache(size_t sizeMb);
+
+	bool Get(Hash key, int8_t depth, uint64_t& count) const;
+	void Set(Hash key, int8_t depth, uint64_t count);
+
+private:
+	inline PerftCacheBucket& GetBucket(Hash key) { return m_table[(static_cast<uint64_t>(static_cast<uint32_t>(key)) * m_numBuckets) >> 32]; }
+	inline const PerftCacheBucket& GetBucket(Hash key) const { return m_table[(static_cast<uint64_t>(static_cast<uint32_t>(key)) * m_numBuckets) >> 32]; }
+
+	static bool Get(const PerftCacheEntry& entry, Hash key, int8_t depth, uint64_t& count);
+
+	size_t 								m_numBuckets;
+	std::unique_ptr<PerftCacheBucket[]> m_table;
+};
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "Config.h"
 
 #include "BoardRepresentation/Board.h"
@@ -7,65 +13,87 @@
 #include "BoardRepresentation/Pieces.h"
 
 #include "Engine/Constants.h"
-#include "Engine/Killers.h"
-#include "Engine/MagicBitboardHelper.h"
 #include "Engine/Move.h"
 #include "Engine/MoveGenerator.h"
-#include "Engine/MoveHistory.h"
-#include "Engine/PrincipleVariation.h"
+#include "Engine/Nnue.h"
+#include "Engine/PerftCache.h"
+#include "Engine/Searcher.h"
 #include "Engine/TranspositionTable.h"
 #include "Engine/Undo.h"
 
 
+struct PerftParameters {
+	size_t 	m_numThreads;
+
+	// Zero for no cache.
+	size_t 	m_cacheSizeMb;
+
+	// Count the last ply straight from the size of the move list instead of making and unmaking each move.
+	bool 	m_isBulkCounting;
+
+	// Print each root move's count as well as the total.
+	bool 	m_isDivide;
+};
+
 class Player {
 public:
 	Player(Board& board);
 
 	int16_t Evaluate();
 
-	Move Go(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime);
+	Move Go(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime, bool infinite);
 
-	int RootPerft(int8_t depth);
+	// Stop may be called from another thread while Go is running. The stop flag is only cleared by
+	// ClearStop, which must happen before the search is launched so that an early stop is never lost.
+	inline void Stop() noexcept { m_isStopped = true; }
+	inline void ClearStop() noexcept { m_isStopped = false; }
 
-	inline void ClearTranspositionTable() { m_transpositionTable.Clear(); }
+	// Pondering searches without a deadline until PonderHit turns it into a normal timed search.
+	// Like ClearStop, SetPondering must be called before the search is launched.
+	inline void SetPondering(bool isPondering) noexcept { m_isPondering = isPondering; }
+	void PonderHit();
 
-private:
-	void InitialisePieceSquareTables();
+	bool GetPonderMove(const Move& bestMove, Move& ponderMove);
 
-	Move IterativeDeepening(int8_t maxDepth);
+	// Splits the root moves between the threads and prints the count under each of them.
+	uint64_t RootPerft(int8_t depth, const PerftParameters& params, PerftStatistics& statistics);
 
-	int16_t RootNegamax(int8_t depth, int16_t alpha, int16_t beta, const Move& prevBestMove, Move& bestMove);
-	int16_t Negamax(int8_t depth, int8_t ply, int16_t alpha, int16_t beta, bool nmp = false);
+	void SetThreads(size_t numThreads);
+	inline size_t GetThreads() const noexcept { return m_searchers.size(); }
 
-	int16_t Quiescence(int8_t ply, int16_t alpha, int16_t beta);
+	// Clears everything learnt from earlier searches, so that the next search doesn't depend on what came before.
+	void NewGame();
 
-#if DEBUG
-	void PrintPv(int8_t depth);
-#endif
+	// The nodes searched by all threads in the last Go.
+	uint64_t GetNodesSearched() const noexcept;
 
-	int Perft(int8_t depth);
+	inline size_t GetTranspositionTableSize() const noexcept { return m_transpositionTable.GetSizeMb(); }
+	inline void SetTranspositionTableSize(size_t sizeMb) { m_transpositionTable.Resize(sizeMb); }
+	inline void AllocateTranspositionTable() { m_transpositionTable.Allocate(); }
 
-	Board& 					m_board;
-	MoveGenerator 			m_moveGenerator;
-	TranspositionTable 		m_transpositionTable;
-	Killers					m_killers;
-	MoveHistory				m_moveHistory;
-#if DEBUG
-	PrincipleVariation		m_principleVariation;
-#endif
+	// The network is loaded the first time it is turned on, and reloaded if the file changes while it is on.
+	// If it can't be loaded, evaluation stays on (or falls back to) the PSTs.
+	bool SetNetworkFile(const std::string& path);
+	bool SetUseNetwork(bool useNetwork);
+
+private:
+	static uint64_t Perft(Board& board, const MoveGenerator& moveGenerator, int8_t depth, bool isBulkCounting, PerftCache* cache, PerftStatistics& statistics);
 
-	int 	m_nodesSearched;
+	Board& 									m_board;
+	MoveGenerator 							m_moveGenerator;
+	TranspositionTable 						m_transpositionTable;
 
-	Moment 	m_deadline;
-	bool 	m_isStopped;
+	NnueNetwork 							m_network;
+	std::string 							m_networkFile;
+	bool 									m_useNetwork;
 
-	std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, static_cast<size_t>(Piece::NUM_PIECES)> m_midgamePieceSquareTables;
-	std::array<std::array<int, static_cast<size_t>(Square::COUNT)>, static_cast<size_t>(Piece::NUM_PIECES)> m_endgamePieceSquareTables;
+	// m_searchers[0] is the main thread; the rest are Lazy SMP helpers.
+	std::vector<std::unique_ptr<Searcher>> 	m_searchers;
 
+	std::atomic<Moment> 					m_deadline;
+	std::atomic<bool> 						m_isStopped;
 
-#if DEBUG
-	int 	m_transpositionsHit;
-	int 	m_currentDepthNodes;
-	int 	m_quiescenceNodesSearched;
-#endif
+	std::atomic<bool> 						m_isPondering;
+	ms 										m_timeAllowed;
+	std::mutex 								m_ponderMutex;
 };
\ No newline at end of file
@@ -32,7 +32,7 @@ inline void PrincipleVariation::Set(size_t ply, Move move) noexcept {
 
 	for (size_t i = 0; i < m_length[ply+1]; ++i) {
 #if DEBUG
-		if (m_line[ply+1][i].m_from == Square::NONE) {
+		if (m_line[ply+1][i].IsNull()) {
 			std::cerr << "PV invalid move error; next ply length: " << m_length[ply+1] << ", trying to get pv move of ply: " << ply+1 << '\n';
 			std::abort();
 		}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+
+#include "Config.h"
+
+#include "BoardRepresentation/Board.h"
+#include "BoardRepresentation/Bitboard.h"
+#include "BoardRepresentation/Pieces.h"
+
+#include "Engine/Constants.h"
+#include "Engine/Killers.h"
+#include "Engine/Move.h"
+#include "Engine/MoveGenerator.h"
+#include "Engine/MoveHistory.h"
+#include "Engine/MovePicker.h"
+#include "Engine/PrincipleVariation.h"
+#include "Engine/TranspositionTable.h"
+#include "Engine/Undo.h"
+
+
+// A single search thread. Each searcher owns its own copy of the board and its own move ordering
+// heuristics, but all searchers share the player's transposition table, deadline and stop flag.
+// Searcher 0 is the main thread; any others are Lazy SMP helpers whose only output is the TT entries they leave behind.
+class Searcher {
+public:
+	Searcher(size_t id, TranspositionTable& transpositionTable, const std::atomic<Moment>& deadline, std::atomic<bool>& isStopped);
+
+	inline void SetPosition(const Board& board) { m_board = board; }
+
+	int16_t Evaluate();
+
+	Move IterativeDeepening(int8_t maxDepth);
+
+	inline uint64_t GetNodesSearched() const noexcept { return m_nodesSearched; }
+
+	// Forget the move ordering history, ready for a new game.
+	inline void Clear() noexcept { m_killers.Reset(); m_moveHistory = MoveHistory{}; }
+
+	inline bool IsMainThread() const noexcept { return m_id == 0; }
+
+private:
+	int16_t RootNegamax(int8_t depth, int16_t alpha, int16_t beta, const Move& prevBestMove, Move& bestMove);
+	int16_t Negamax(int8_t depth, int8_t ply, int16_t alpha, int16_t beta, bool nmp = false);
+
+	int16_t Quiescence(int8_t ply, int16_t alpha, int16_t beta, bool includesQuietChecks = false);
+
+#if DEBUG
+	void PrintPv(int8_t depth);
+#endif
+
+	size_t 					m_id;
+
+	Board 					m_board;
+	MoveGenerator 			m_moveGenerator;
+	TranspositionTable& 	m_transpositionTable;
+	Killers					m_killers;
+	MoveHistory				m_moveHistory;
+#if DEBUG
+	PrincipleVariation		m_principleVariation;
+#endif
+
+	uint64_t 				m_nodesSearched;
+
+	// Only ever goes up, so a node can tell whether its subtree hit a repetition by comparing before and after.
+	uint64_t 				m_repetitionsFound;
+
+	const std::atomic<Moment>&	m_deadline;
+	std::atomic<bool>& 		m_isStopped;
+
+#if DEBUG
+	int 	m_transpositionsHit;
+	int 	m_currentDepthNodes;
+	int 	m_quiescenceNodesSearched;
+#endif
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
 
 #include "Config.h"
 #include "BoardRepresentation/Zobrist.h"
@@ -10,31 +12,86 @@
 enum class EvaluationType : uint8_t {
 	EXACT,
 	LOWER_BOUND,
-	UPPER_BOUND
+	UPPER_BOUND,
+	// Only the move can be used. The score came from a search that ran into a repetition, so it depends on the path to it.
+	MOVE_ONLY
 };
 
+constexpr size_t CACHE_LINE_SIZE_BYTES = 64;
+
+#define EVALUATION_TYPE_BITS 2
+#define EVALUATION_TYPE_MASK ((1 << EVALUATION_TYPE_BITS) - 1)
+#define GENERATION_CYCLE (1 << (8 - EVALUATION_TYPE_BITS))
+
+// How many plies of depth an entry is worth per search it has aged by, when choosing what to replace.
+#define AGE_DEPTH_PENALTY 8
+
 struct TranspositionTableEntry {
 	Move			m_move;
-	Hash 			m_key;
 	int16_t 		m_score;
 	int8_t 			m_depth;
-	EvaluationType 	m_evaluationType;
+	uint8_t 		m_generationAndEvaluationType;
+
+	inline EvaluationType GetEvaluationType() const noexcept { return static_cast<EvaluationType>(m_generationAndEvaluationType & EVALUATION_TYPE_MASK); }
+	inline uint8_t GetGeneration() const noexcept { return m_generationAndEvaluationType >> EVALUATION_TYPE_BITS; }
+};
+
+// How an entry is kept in the table, where any number of search threads may be reading and writing it at once. The
+// entry is packed into one word, and the key is stored XORed with it, as in the perft cache. An entry torn between
+// two writes then fails the key check instead of pairing this position's key with another position's score, depth
+// or bound. An empty slot holds a key of 0.
+struct TranspositionTableSlot {
+	std::atomic<uint64_t> m_keyXorData;
+	std::atomic<uint64_t> m_data;
+};
+
+constexpr size_t ENTRIES_PER_BUCKET = CACHE_LINE_SIZE_BYTES / sizeof(TranspositionTableSlot);
+
+// All the entries a position can live in share one cache line, so a probe costs at most one miss.
+struct alignas(CACHE_LINE_SIZE_BYTES) TranspositionTableBucket {
+	std::array<TranspositionTableSlot, ENTRIES_PER_BUCKET> m_slots;
 };
 
-constexpr size_t TRANSPOSITION_TABLE_SIZE_BYTES = TRANSPOSITION_TABLE_SIZE_MB * 1024 * 1024;
-constexpr size_t TRANSPOSITION_TABLE_RAW_NUM_ENTRIES = TRANSPOSITION_TABLE_SIZE_BYTES / sizeof(TranspositionTableEntry);
+static_assert(sizeof(TranspositionTableBucket) == CACHE_LINE_SIZE_BYTES);
 
 class TranspositionTable {
 public:
 	TranspositionTable();
 
-	const TranspositionTableEntry* GetEntry(Hash key) const;
-	void SetEntry(Hash key, TranspositionTableEntry entry);
+	// Nothing is allocated until Allocate is called (on isready or at the start of a search), so a Hash
+	// option sent straight after uci never has the default sized table allocated first. Resize drops the contents.
+	void Resize(size_t sizeMb);
+	void Allocate();
+
+	inline size_t GetSizeMb() const noexcept { return m_sizeMb; }
+
+	// Entries are copied out rather than pointed to, since other search threads may overwrite them at any time.
+	// A copy that was torn by one of those writes fails the key check and is treated as a miss.
+	bool GetEntry(Hash key, TranspositionTableEntry& entry) const;
+	void SetEntry(Hash key, const Move& move, int16_t score, int8_t depth, EvaluationType evaluationType);
+
+	// Called at the start of every search so that entries left over from earlier searches can be recognised as stale.
+	inline void NewSearch() noexcept { m_generation = (m_generation + 1) % GENERATION_CYCLE; }
 
 	void Clear();
 
 private:
-	size_t m_numEntries;
-	std::vector<TranspositionTableEntry> m_table;
+	// Map the low 32 bits of the key onto [0, m_numBuckets) with a multiply rather than a mask, so the
+	// table doesn't need a power of two number of buckets and the requested size is used in full.
+	inline size_t GetBucketIndex(Hash key) const noexcept { return (static_cast<uint64_t>(static_cast<uint32_t>(key)) * m_numBuckets) >> 32; }
+
+	inline TranspositionTableBucket& GetBucket(Hash key) { return m_table[GetBucketIndex(key)]; }
+	inline const TranspositionTableBucket& GetBucket(Hash key) const { return m_table[GetBucketIndex(key)]; }
+
+	// The move in bits 0-15, the score in 16-31, the depth in 32-39 and the generation and type in 40-47.
+	static uint64_t PackEntry(const TranspositionTableEntry& entry) noexcept;
+	static TranspositionTableEntry UnpackEntry(uint64_t data) noexcept;
+
+	inline uint8_t GetAge(const TranspositionTableEntry& entry) const noexcept { return (GENERATION_CYCLE + m_generation - entry.GetGeneration()) % GENERATION_CYCLE; }
+
+	size_t m_sizeMb;
+	size_t m_numBuckets;
+	std::unique_ptr<TranspositionTableBucket[]> m_table;
 
+	uint8_t m_generation;
 };
\ No newline at end of file
@@ -1,14 +1,23 @@
 #pragma once
 
 #include <ctime>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <random>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "BoardRepresentation/Board.h"
 
+#include "Interface/Bench.h"
+#include "Interface/NnueCheck.h"
+#include "Interface/PerftSuite.h"
+
 #include "Engine/Move.h"
 #include "Engine/MoveGenerator.h"
+#include "Engine/Nnue.h"
 #include "Engine/Player.h"
 
 #define ENGINE_NAME "Knifefish"
@@ -18,17 +27,30 @@
 class Interface {
 public:
 	Interface();
+	~Interface();
 
 	void ListenForConnection();
 	void ListenForCommands();
 
 	bool ProcessCommand(std::string input);
 
+	// Set when a command given on the command line (rather than over UCI) should make the engine exit with an error.
+	inline bool HasCommandFailed() const noexcept { return m_hasCommandFailed; }
+
 private:
 	bool Position(std::istringstream& tokenStream);
 	bool StartPosition(std::istringstream& tokenStream);
 	bool Go(std::istringstream& tokenStream);
 	bool Perft(std::istringstream& tokenStream);
+	bool Bench(std::istringstream& tokenStream);
+	bool PerftSuite(std::istringstream& tokenStream);
+	bool SliderBench(std::istringstream& tokenStream);
+	bool NnueCheck(std::istringstream& tokenStream);
+	bool SetOption(std::istringstream& tokenStream);
+
+	void Search(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime, bool infinite);
+	void StopSearch();
+	void WaitForSearch();
 
 	void FlushCommandHistory();
 
@@ -37,4 +59,10 @@ private:
 	Player 						m_player;
 
 	std::vector<std::string> 	m_commandHistory;
+
+	// Searches run here so that stop, isready and quit can still be read from stdin mid-search.
+	std::thread 				m_searchThread;
+	std::mutex 					m_outputMutex;
+
+	bool 						m_hasCommandFailed;
 };
\ No newline at end of file
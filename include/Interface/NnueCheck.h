@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// nnuecheck loads a small hand-made network and checks its eval of each position below against a value worked out
+// by hand. Only the first three hidden units have any input weights:
+//   0: our material, with a pawn worth 6
+//   1: their material, the same
+//   2: how far our pawns have advanced, 6 per rank past their starting rank
+// The output weights are +340, -340 and +340 from the side to move's point of view and the reverse from the other
+// side's, and the output bias is 1020. That makes the eval in centipawns
+// 100 * (our material - their material in pawns) + 50 * (our pawn advancement - theirs) + 25.
+#define NNUE_CHECK_UNIT_WEIGHT 6
+#define NNUE_CHECK_OUTPUT_WEIGHT 340
+#define NNUE_CHECK_OUTPUT_BIAS 1020
+
+// Pawn, knight, bishop, rook, queen and king.
+constexpr std::array<int16_t, 6> NNUE_CHECK_MATERIAL { 1, 3, 3, 5, 9, 0 };
+
+struct NnueCheckPosition {
+	std::string_view 	m_name;
+	std::string_view 	m_fen;
+	int 				m_eval;
+};
+
+// Both sides to move, and each side's pawns advancing, so that a wrong perspective or mirroring shows up too.
+constexpr std::array<NnueCheckPosition, 6> NNUE_CHECK_POSITIONS {{
+	{ "Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 25 },
+	{ "After e4", "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", -75 },
+	{ "Knight and passed pawn up", "4k3/8/8/3P4/8/8/8/3NK3 w - - 0 1", 575 },
+	{ "Knight and passed pawn down", "4k3/8/8/3P4/8/8/8/3NK3 b - - 0 1", -525 },
+	{ "Knight and passed pawn up (mirrored)", "3nk3/8/8/8/3p4/8/8/4K3 b - - 0 1", 575 },
+	{ "Queen up", "r3k3/8/8/8/8/8/8/R2QK3 w - - 0 1", 925 }
+}};
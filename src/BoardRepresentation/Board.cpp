@@ -2,14 +2,21 @@
 
 Board::Board() :
 	m_pieceBitboards{},
+	m_colourBitboards{},
+	m_allPieceBitboard{},
 	m_boardPieces{},
 	m_castlePermissions{},
 	m_enPassantSquare{},
 	m_isWhiteTurn{},
+	m_moveCount{},
 	m_repetitionStack{},
 	m_repetitionStackHead{},
 	m_repetitionStackTail{},
 	m_phase{},
+	m_midgameScore{},
+	m_endgameScore{},
+	m_network{nullptr},
+	m_accumulator{},
 	m_zobrist{}
 {
 	SetUpStartPosition();
@@ -28,6 +35,14 @@ void Board::SetUpStartPosition() {
 	PIECES_LIST
 	#undef X
 
+	m_colourBitboards.fill(0ULL);
+	m_allPieceBitboard = 0ULL;
+	m_midgameScore = 0;
+	m_endgameScore = 0;
+
+	if (m_network)
+		m_network->ResetAccumulator(m_accumulator);
+
 	m_boardPieces.fill(Piece::EMPTY);
 
 	Bitboard bb;
@@ -40,6 +55,7 @@ void Board::SetUpStartPosition() {
 	#undef X
 
 	m_repetitionStackTail = m_repetitionStackHead = 0;
+	m_moveCount = 0;
 	m_phase = START_PHASE;
 	RebuildHash();
 }
@@ -74,9 +90,21 @@ void Board::SetUpFenPosition(std::istringstream& tokenStream) {
 	PIECES_LIST
 	#undef X
 
+	m_colourBitboards.fill(0ULL);
+	m_allPieceBitboard = 0ULL;
+	m_midgameScore = 0;
+	m_endgameScore = 0;
+
+	if (m_network)
+		m_network->ResetAccumulator(m_accumulator);
+
 	m_boardPieces.fill(Piece::EMPTY);
 
-	#define X(square) PutDown(piecePositions[static_cast<size_t>(Square::square)], Square::square);
+	// Empty squares must not go through PutDown, which indexes its tables by piece.
+	#define X(square) 																\
+	if (piecePositions[static_cast<size_t>(Square::square)] != Piece::EMPTY) 			\
+		PutDown(piecePositions[static_cast<size_t>(Square::square)], Square::square);
+
 	SQUARE_LIST
 	#undef X
 
@@ -111,7 +139,7 @@ void Board::SetUpFenPosition(std::istringstream& tokenStream) {
 			SetCastlePermission(CastlePermission::BLACK_KINGSIDE, true);
 		else if (c == 'q')
 			SetCastlePermission(CastlePermission::BLACK_QUEENSIDE, true);
-		else
+		else if (c != '-')
 			std::exit(1);
 	}
 
@@ -120,28 +148,35 @@ void Board::SetUpFenPosition(std::istringstream& tokenStream) {
 	if (!(tokenStream >> enPassantString))
 		std::exit(1);
 
+	// "-" (or anything else that isn't a square) means there is no en passant square.
+	m_enPassantSquare = Square::NONE;
+
 	Square enPassantSquare = StringToSquare(enPassantString);
-	Bitboard enPassantBB{enPassantSquare};
-	Bitboard movedPawnBB = m_isWhiteTurn ? enPassantBB.ShiftSouth() : enPassantBB.ShiftNorth();
-	Piece attackingPawnPiece = m_isWhiteTurn ? Piece::WHITE_PAWN : Piece::BLACK_PAWN;
-	Bitboard attackingPawnBB = m_pieceBitboards[static_cast<size_t>(attackingPawnPiece)] & (movedPawnBB.ShiftEast() | movedPawnBB.ShiftWest());
-	m_enPassantSquare = attackingPawnBB.Any() ? enPassantSquare : Square::NONE;
+	if (enPassantSquare != Square::NONE) {
+		Bitboard enPassantBB{enPassantSquare};
+		Bitboard movedPawnBB = m_isWhiteTurn ? enPassantBB.ShiftSouth() : enPassantBB.ShiftNorth();
+		Piece attackingPawnPiece = m_isWhiteTurn ? Piece::WHITE_PAWN : Piece::BLACK_PAWN;
+		Bitboard attackingPawnBB = m_pieceBitboards[static_cast<size_t>(attackingPawnPiece)] & (movedPawnBB.ShiftEast() | movedPawnBB.ShiftWest());
+		if (attackingPawnBB.Any())
+			m_enPassantSquare = enPassantSquare;
+	}
 
 	// For now I'm ignoring the 50-move count and the halfmove clock and the fullmove number
 
-	// Calculate phase
+	// Calculate phase. It goes up towards START_PHASE with each piece on the board, just as it does on a promotion.
 	m_phase = END_PHASE;
 	Piece piece;
 	#define X(square) 												\
 																	\
 	piece = m_boardPieces[static_cast<size_t>(Square::square)]; 	\
 	if (piece != Piece::EMPTY)										\
-		ProgressPhase(piece);
+		RegressPhase(piece);
 
 	SQUARE_LIST
 	#undef X
 
 	m_repetitionStackTail = m_repetitionStackHead = 0;
+	m_moveCount = 0;
 	RebuildHash();
 }
 
@@ -181,13 +216,19 @@ void Board::CheckKingCount(const Move& move) const {
 #endif
 
 bool Board::IsRepeatPosition() const noexcept {
-	Hash hash = GetHash();
+	// The same side has to be to move, and it takes at least four plies to get back to a position,
+	// so only every other entry from four plies ago needs checking.
+	if ((m_repetitionStackHead - m_repetitionStackTail) < 4)
+		return false;
 
-	for (size_t i = m_repetitionStackTail; i < m_repetitionStackHead; ++i) {
-		Hash currentHash = m_repetitionStack[i];
+	Hash hash = GetHash();
 
-		if (currentHash == hash)
+	for (size_t i = m_repetitionStackHead - 4; i >= m_repetitionStackTail; i -= 2) {
+		if (m_repetitionStack[i] == hash)
 			return true;
+
+		if (i < (m_repetitionStackTail + 2))
+			break;
 	}
 
 	return false;
@@ -226,36 +267,6 @@ bool Board::CheckQuietDraws() const noexcept {
 	return false;
 }
 
-Bitboard Board::GetAllPieceBitboard() const {
-	Bitboard allPieces{0ULL};
-
-	#define X(piece) allPieces |= m_pieceBitboards[Piece::piece];
-	PIECES_LIST
-	#undef X
-
-	return allPieces;
-}
-
-Bitboard Board::GetWhitePieceBitboard() const {
-	Bitboard whitePieces{0ULL};
-
-	#define X(piece) whitePieces |= m_pieceBitboards[Piece::piece];
-	WHITE_PIECES_LIST;
-	#undef X
-
-	return whitePieces;
-}
-
-Bitboard Board::GetBlackPieceBitboard() const {
-	Bitboard blackPieces{0ULL};
-
-	#define X(piece) blackPieces |= m_pieceBitboards[Piece::piece];
-	BLACK_PIECES_LIST;
-	#undef X
-
-	return blackPieces;
-}
-
 void Board::RebuildHash() {
 	m_zobrist.ResetHash();
 
@@ -276,6 +287,31 @@ void Board::RebuildHash() {
 		m_zobrist.ApplyWhiteTurnHash();
 }
 
+void Board::SetNetwork(const NnueNetwork* network) {
+	m_network = network;
+	RebuildAccumulator();
+}
+
+void Board::RebuildAccumulator() {
+	if (!m_network)
+		return;
+
+	m_network->ResetAccumulator(m_accumulator);
+
+	#define X(piece) 											\
+	for (Square sq : GetPieceBitboard(Piece::piece))			\
+		m_network->AddPiece(m_accumulator, Piece::piece, sq);
+
+	PIECES_LIST
+	#undef X
+}
+
+void Board::SetCastlePermissions(uint8_t castlePermissions) noexcept {
+	#define X(permission) SetCastlePermission(CastlePermission::permission, castlePermissions & CastlePermission::permission);
+	CASTLE_PERMISSIONS_LIST
+	#undef X
+}
+
 void Board::SetEnPassantSquare(Square square) noexcept {
 	if (m_enPassantSquare == square) return;
 
@@ -292,7 +328,13 @@ bool Board::PickUp(Piece piece, const Location& loc) {
 #endif
 
 	m_pieceBitboards[piece] &= ~loc.m_bitboard;
+	m_colourBitboards[GetColourIndex(piece)] &= ~loc.m_bitboard;
+	m_allPieceBitboard &= ~loc.m_bitboard;
 	m_boardPieces[static_cast<size_t>(loc.m_square)] = Piece::EMPTY;
+	m_midgameScore -= MG_PIECE_SQUARE_TABLES[piece][static_cast<size_t>(loc.m_square)];
+	m_endgameScore -= EG_PIECE_SQUARE_TABLES[piece][static_cast<size_t>(loc.m_square)];
+	if (m_network)
+		m_network->RemovePiece(m_accumulator, piece, loc.m_square);
 	m_zobrist.ApplyPieceHash(piece, loc.m_square);
 
 	return true;
@@ -306,11 +348,22 @@ bool Board::PutDown(Piece piece, const Location& loc) {
 #endif
 
 	m_pieceBitboards[piece] |= loc.m_bitboard;
+	m_colourBitboards[GetColourIndex(piece)] |= loc.m_bitboard;
+	m_allPieceBitboard |= loc.m_bitboard;
 	m_boardPieces[static_cast<size_t>(loc.m_square)] = piece;
+	m_midgameScore += MG_PIECE_SQUARE_TABLES[piece][static_cast<size_t>(loc.m_square)];
+	m_endgameScore += EG_PIECE_SQUARE_TABLES[piece][static_cast<size_t>(loc.m_square)];
+	if (m_network)
+		m_network->AddPiece(m_accumulator, piece, loc.m_square);
 	m_zobrist.ApplyPieceHash(piece, loc.m_square);
 	return true;
 }
 
+Undo Board::MakeMove(const Move& move) {
+	return IsWhiteTurn() ? MakeMove<Colour::WHITE>(move) : MakeMove<Colour::BLACK>(move);
+}
+
+template<Colour Us>
 Undo Board::MakeMove(const Move& move) {
 	Undo undo {
 		Piece::EMPTY,
@@ -323,30 +376,30 @@ Undo Board::MakeMove(const Move& move) {
 
 	SetEnPassantSquare(Square::NONE);
 
-	Location from { move.m_from, Bitboard{move.m_from} };
-	Location to { move.m_to, Bitboard{move.m_to} };
+	Location from { move.GetFrom(), Bitboard{move.GetFrom()} };
+	Location to { move.GetTo(), Bitboard{move.GetTo()} };
 
-	Piece promotionPiece = move.m_promotionPiece;
+	Piece promotionPiece = move.GetPromotionPiece(Us == Colour::WHITE);
 
 	bool isReversible = false;
 
-	if (move.m_isCapture) {
+	if (move.IsEnPassant()) {
+		DoEnPassantCapture<Us>(to);
+	} else if (move.IsCapture()) {
 		DoCapture(from, to, undo);
-	} else if (move.m_isEnPassant) {
-		DoEnPassantCapture(to);
-	} else if (move.m_isDoublePawnPush) {
-		DoDoublePawnPush(to);
+	} else if (move.IsDoublePawnPush()) {
+		DoDoublePawnPush<Us>(to);
 	}
 
-	if (move.m_isCastle) {
-		MakeCastleMove(to);
-	} else if (move.m_promotionPiece != Piece::EMPTY) {
-		MakePromotionMove(from, to, promotionPiece);
+	if (move.IsCastle()) {
+		MakeCastleMove<Us>(to);
+	} else if (move.IsPromotion()) {
+		MakePromotionMove<Us>(from, to, promotionPiece);
 	} else {
-		MakeQuietMove(from, to, isReversible);
+		MakeQuietMove<Us>(from, to, isReversible);
 	}
 
-	if (!isReversible)
+	if (move.IsCapture() || !isReversible)
 		ResetRepetitionStack();
 	
 	PushToRepetitionStack(hash);
@@ -385,16 +438,13 @@ void Board::DoCapture(const Location& from, const Location& to, Undo& undo) {
 	ProgressPhase(piece);
 }
 
+template<Colour Us>
 void Board::DoEnPassantCapture(const Location& to) {
-	Bitboard captureBB = IsWhiteTurn() ? to.m_bitboard.ShiftSouth() : to.m_bitboard.ShiftNorth();
-	Location captureLoc { static_cast<Square>(captureBB), captureBB };
-	if (IsWhiteTurn()) {
-		SAFE_CALL(PickUp(Piece::BLACK_PAWN, captureLoc));
-	} else {
-		SAFE_CALL(PickUp(Piece::WHITE_PAWN, captureLoc));
-	}
+	Bitboard captureBB = ColourTraits<Us>::ShiftBackward(to.m_bitboard);
+	SAFE_CALL(PickUp(ColourTraits<GetOtherColour(Us)>::PAWN, captureBB));
 }
 
+template<Colour Us>
 void Board::DoDoublePawnPush(const Location& to) {
 	// Only bother setting the en passant square if there is a pawn that could capture because
 	// of it. This is relevant when you consider three-fold repetition. An en passant square which
@@ -402,63 +452,43 @@ void Board::DoDoublePawnPush(const Location& to) {
 	// we should *not* include it. This is mostly important because our hash helps us do three-fold
 	// repetition detection, so we should not be hashing for an irrelevant en passant square.
 
-	if (IsWhiteTurn()) {
-		Bitboard blackPawns = GetPieceBitboard(Piece::BLACK_PAWN);
-		if ((blackPawns & to.m_bitboard.ShiftWest()).Any() || (blackPawns & to.m_bitboard.ShiftEast()).Any() )
-			SetEnPassantSquare(to.m_bitboard.ShiftSouth());
-	}
-	else {
-		Bitboard whitePawns = GetPieceBitboard(Piece::WHITE_PAWN);
-		if ((whitePawns & to.m_bitboard.ShiftWest()).Any() || (whitePawns & to.m_bitboard.ShiftEast()).Any() )
-			SetEnPassantSquare(to.m_bitboard.ShiftNorth());
-	}
+	Bitboard enemyPawns = GetPieceBitboard(ColourTraits<GetOtherColour(Us)>::PAWN);
+	if ((enemyPawns & to.m_bitboard.ShiftWest()).Any() || (enemyPawns & to.m_bitboard.ShiftEast()).Any())
+		SetEnPassantSquare(ColourTraits<Us>::ShiftBackward(to.m_bitboard));
 }
 
+template<Colour Us>
 void Board::MakeCastleMove(const Location& to) {
-	if (IsWhiteTurn()) {
-		bool isKingside = (to.m_bitboard == G1_MASK);
-		if (isKingside) {
-			SAFE_CALL(PickUp(Piece::WHITE_KING, E1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_KING, G1_MASK));
-			SAFE_CALL(PickUp(Piece::WHITE_ROOK, H1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_ROOK, F1_MASK));
-		} else {
-			SAFE_CALL(PickUp(Piece::WHITE_KING, E1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_KING, C1_MASK));
-			SAFE_CALL(PickUp(Piece::WHITE_ROOK, A1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_ROOK, D1_MASK));
-		}
-		SetCastlePermission(CastlePermission::WHITE_KINGSIDE, false);
-		SetCastlePermission(CastlePermission::WHITE_QUEENSIDE, false);
+	using Traits = ColourTraits<Us>;
+
+	bool isKingside = (to.m_bitboard == Traits::KINGSIDE_KING_END_MASK);
+	if (isKingside) {
+		SAFE_CALL(PickUp(Traits::KING, Traits::KING_START_MASK));
+		SAFE_CALL(PutDown(Traits::KING, Traits::KINGSIDE_KING_END_MASK));
+		SAFE_CALL(PickUp(Traits::ROOK, Traits::KINGSIDE_ROOK_START_MASK));
+		SAFE_CALL(PutDown(Traits::ROOK, Traits::KINGSIDE_ROOK_END_MASK));
 	} else {
-		bool isKingside = (to.m_bitboard == G8_MASK);
-		if (isKingside) {
-			SAFE_CALL(PickUp(Piece::BLACK_KING, E8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_KING, G8_MASK));
-			SAFE_CALL(PickUp(Piece::BLACK_ROOK, H8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_ROOK, F8_MASK));
-		} else {
-			SAFE_CALL(PickUp(Piece::BLACK_KING, E8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_KING, C8_MASK));
-			SAFE_CALL(PickUp(Piece::BLACK_ROOK, A8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_ROOK, D8_MASK));
-		}
-		SetCastlePermission(CastlePermission::BLACK_KINGSIDE, false);
-		SetCastlePermission(CastlePermission::BLACK_QUEENSIDE, false);
-
+		SAFE_CALL(PickUp(Traits::KING, Traits::KING_START_MASK));
+		SAFE_CALL(PutDown(Traits::KING, Traits::QUEENSIDE_KING_END_MASK));
+		SAFE_CALL(PickUp(Traits::ROOK, Traits::QUEENSIDE_ROOK_START_MASK));
+		SAFE_CALL(PutDown(Traits::ROOK, Traits::QUEENSIDE_ROOK_END_MASK));
 	}
+	SetCastlePermission(Traits::KINGSIDE, false);
+	SetCastlePermission(Traits::QUEENSIDE, false);
 }
 
+template<Colour Us>
 void Board::MakePromotionMove(const Location& from, const Location& to, Piece promotionPiece) {
-	Piece pawn = IsWhiteTurn() ? Piece::WHITE_PAWN : Piece::BLACK_PAWN;
-
-	SAFE_CALL(PickUp(pawn, from));
+	SAFE_CALL(PickUp(ColourTraits<Us>::PAWN, from));
 	SAFE_CALL(PutDown(promotionPiece, to));
 
 	RegressPhase(promotionPiece);
 }
 
+template<Colour Us>
 void Board::MakeQuietMove(const Location& from, const Location& to, bool& isReversible) {
+	using Traits = ColourTraits<Us>;
+
 	isReversible = true;
 
 	Piece piece = GetPieceAtSquare(from.m_square);
@@ -466,27 +496,16 @@ void Board::MakeQuietMove(const Location& from, const Location& to, bool& isReve
 	SAFE_CALL(PutDown(piece, to));
 
 	// Turn off castling if applicable
-	if (IsWhiteTurn()) {
-		if (GetCastlePermission(CastlePermission::WHITE_KINGSIDE) && (from.m_bitboard == E1_MASK || from.m_bitboard == H1_MASK)) {
-			SetCastlePermission(CastlePermission::WHITE_KINGSIDE, false);
-			isReversible = false;
-		}
-		if (GetCastlePermission(CastlePermission::WHITE_QUEENSIDE) && (from.m_bitboard == E1_MASK || from.m_bitboard == A1_MASK)) {
-			SetCastlePermission(CastlePermission::WHITE_QUEENSIDE, false);
-			isReversible = false;
-		}
-	} else {
-		if (GetCastlePermission(CastlePermission::BLACK_KINGSIDE) && (from.m_bitboard == E8_MASK || from.m_bitboard == H8_MASK)) {
-			SetCastlePermission(CastlePermission::BLACK_KINGSIDE, false);
-			isReversible = false;
-		}
-		if (GetCastlePermission(CastlePermission::BLACK_QUEENSIDE) && (from.m_bitboard == E8_MASK || from.m_bitboard == A8_MASK)) {
-			SetCastlePermission(CastlePermission::BLACK_QUEENSIDE, false);
-			isReversible = false;
-		}
+	if (GetCastlePermission(Traits::KINGSIDE) && (from.m_bitboard == Traits::KING_START_MASK || from.m_bitboard == Traits::KINGSIDE_ROOK_START_MASK)) {
+		SetCastlePermission(Traits::KINGSIDE, false);
+		isReversible = false;
+	}
+	if (GetCastlePermission(Traits::QUEENSIDE) && (from.m_bitboard == Traits::KING_START_MASK || from.m_bitboard == Traits::QUEENSIDE_ROOK_START_MASK)) {
+		SetCastlePermission(Traits::QUEENSIDE, false);
+		isReversible = false;
 	}
 
-	if (piece == Piece::WHITE_PAWN || piece == Piece::BLACK_PAWN)
+	if (piece == Traits::PAWN)
 		isReversible = false;
 }
 
@@ -498,6 +517,9 @@ Undo Board::MakeNullMove() {
 		m_repetitionStackTail
 	};
 
+	// Nothing is pushed for a null move, so start a fresh window the way a capture does. Otherwise the every
+	// other entry scan in IsRepeatPosition would be out of step with the side to move.
+	ResetRepetitionStack();
 	SetEnPassantSquare(Square::NONE);
 	SwitchTurn();
 	++m_moveCount;
@@ -508,24 +530,32 @@ Undo Board::MakeNullMove() {
 void Board::UndoMove(const Move& move, const Undo& undo) {
 	SwitchTurn();
 
-	Location from { move.m_from, Bitboard{move.m_from} };
-	Location to { move.m_to, Bitboard{move.m_to}};
+	if (IsWhiteTurn())
+		UndoMove<Colour::WHITE>(move, undo);
+	else
+		UndoMove<Colour::BLACK>(move, undo);
+}
+
+template<Colour Us>
+void Board::UndoMove(const Move& move, const Undo& undo) {
+	Location from { move.GetFrom(), Bitboard{move.GetFrom()} };
+	Location to { move.GetTo(), Bitboard{move.GetTo()}};
 
-	Piece promotionPiece = move.m_promotionPiece;
+	Piece promotionPiece = move.GetPromotionPiece(Us == Colour::WHITE);
 	Piece capturedPiece = undo.m_capturedPiece;
 
-	if (move.m_isCastle) {
-		UndoCastleMove(to);
-	} else if (move.m_promotionPiece != Piece::EMPTY) {
-		UndoPromotionMove(from, to, promotionPiece);
+	if (move.IsCastle()) {
+		UndoCastleMove<Us>(to);
+	} else if (move.IsPromotion()) {
+		UndoPromotionMove<Us>(from, to, promotionPiece);
 	} else {
 		UndoNormalMove(from, to);
 	}
 
-	if (move.m_isCapture) {
+	if (move.IsEnPassant()) {
+		UndoEnPassantCapture<Us>(to);
+	} else if (move.IsCapture()) {
 		UndoCapture(to, capturedPiece);
-	} else if (move.m_isEnPassant) {
-		UndoEnPassantCapture(to);
 	}
 
 	SetEnPassantSquare(undo.m_enPassantSquare);
@@ -545,49 +575,33 @@ void Board::UndoCapture(const Location& to, Piece capturedPiece) {
 	RegressPhase(capturedPiece);
 }
 
+template<Colour Us>
 void Board::UndoEnPassantCapture(const Location& to) {
-	if (IsWhiteTurn()) {
-		SAFE_CALL(PutDown(Piece::BLACK_PAWN, to.m_bitboard.ShiftSouth()));
-	} else {
-		SAFE_CALL(PutDown(Piece::WHITE_PAWN, to.m_bitboard.ShiftNorth()));
-	}
+	SAFE_CALL(PutDown(ColourTraits<GetOtherColour(Us)>::PAWN, ColourTraits<Us>::ShiftBackward(to.m_bitboard)));
 }
 
+template<Colour Us>
 void Board::UndoCastleMove(const Location& to) {
-	if (IsWhiteTurn()) {
-		bool isKingside = (to.m_bitboard == G1_MASK);
-		if (isKingside) {
-			SAFE_CALL(PickUp(Piece::WHITE_KING, G1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_KING, E1_MASK));
-			SAFE_CALL(PickUp(Piece::WHITE_ROOK, F1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_ROOK, H1_MASK));
-		} else {
-			SAFE_CALL(PickUp(Piece::WHITE_KING, C1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_KING, E1_MASK));
-			SAFE_CALL(PickUp(Piece::WHITE_ROOK, D1_MASK));
-			SAFE_CALL(PutDown(Piece::WHITE_ROOK, A1_MASK));
-		}
+	using Traits = ColourTraits<Us>;
+
+	bool isKingside = (to.m_bitboard == Traits::KINGSIDE_KING_END_MASK);
+	if (isKingside) {
+		SAFE_CALL(PickUp(Traits::KING, Traits::KINGSIDE_KING_END_MASK));
+		SAFE_CALL(PutDown(Traits::KING, Traits::KING_START_MASK));
+		SAFE_CALL(PickUp(Traits::ROOK, Traits::KINGSIDE_ROOK_END_MASK));
+		SAFE_CALL(PutDown(Traits::ROOK, Traits::KINGSIDE_ROOK_START_MASK));
 	} else {
-		bool isKingside = (to.m_bitboard == G8_MASK);
-		if (isKingside) {
-			SAFE_CALL(PickUp(Piece::BLACK_KING, G8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_KING, E8_MASK));
-			SAFE_CALL(PickUp(Piece::BLACK_ROOK, F8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_ROOK, H8_MASK));
-		} else {
-			SAFE_CALL(PickUp(Piece::BLACK_KING, C8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_KING, E8_MASK));
-			SAFE_CALL(PickUp(Piece::BLACK_ROOK, D8_MASK));
-			SAFE_CALL(PutDown(Piece::BLACK_ROOK, A8_MASK));
-		}
+		SAFE_CALL(PickUp(Traits::KING, Traits::QUEENSIDE_KING_END_MASK));
+		SAFE_CALL(PutDown(Traits::KING, Traits::KING_START_MASK));
+		SAFE_CALL(PickUp(Traits::ROOK, Traits::QUEENSIDE_ROOK_END_MASK));
+		SAFE_CALL(PutDown(Traits::ROOK, Traits::QUEENSIDE_ROOK_START_MASK));
 	}
 }
 
+template<Colour Us>
 void Board::UndoPromotionMove(const Location& from, const Location& to, Piece promotionPiece) {
-	Piece pawn = IsWhiteTurn() ? Piece::WHITE_PAWN : Piece::BLACK_PAWN;
-
 	SAFE_CALL(PickUp(promotionPiece, to));
-	SAFE_CALL(PutDown(pawn, from));
+	SAFE_CALL(PutDown(ColourTraits<Us>::PAWN, from));
 
 	ProgressPhase(promotionPiece);
 }
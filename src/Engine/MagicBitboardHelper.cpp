@@ -1,12 +1,81 @@
 #include "Engine/MagicBitboardHelper.h"
 
-MagicBitboardHelper::MagicBitboardHelper() :
+#if !defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+
+namespace {
+
+__attribute__((target("bmi2"))) uint64_t ParallelBitExtractBmi2(uint64_t value, uint64_t mask) {
+	return _pext_u64(value, mask);
+}
+
+}
+#endif
+
+const MagicBitboardHelper& MagicBitboardHelper::GetInstance() {
+	// Initialisation of a function-local static is thread-safe, so the first caller builds the tables and everyone else waits for them.
+	static const MagicBitboardHelper instance{ GetBestSliderBackend() };
+	return instance;
+}
+
+std::unique_ptr<const MagicBitboardHelper> MagicBitboardHelper::Create(SliderBackend sliderBackend) {
+	return std::unique_ptr<const MagicBitboardHelper>{ new MagicBitboardHelper(sliderBackend) };
+}
+
+bool MagicBitboardHelper::IsSliderBackendSupported(SliderBackend sliderBackend) {
+	if (sliderBackend != SliderBackend::PEXT)
+		return true;
+
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("bmi2");
+#else
+	return false;
+#endif
+}
+
+SliderBackend MagicBitboardHelper::GetBestSliderBackend() {
+#if defined(__BMI2__)
+	// Zen 1 and 2 have BMI2 but run PEXT in microcode, taking hundreds of cycles, so magics are much faster there.
+	if (IsSliderBackendSupported(SliderBackend::PEXT) && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2"))
+		return SliderBackend::PEXT;
+#endif
+
+	// Without -mbmi2 every PEXT lookup pays for a function call, which costs more than the multiply it saves.
+	return SliderBackend::MAGIC;
+}
+
+#if !defined(__BMI2__)
+uint64_t MagicBitboardHelper::ParallelBitExtract(uint64_t value, uint64_t mask) {
+#if defined(__x86_64__) || defined(__i386__)
+	return ParallelBitExtractBmi2(value, mask);
+#else
+	// Never chosen off x86, but kept so that everything still builds there.
+	uint64_t result = 0;
+	for (uint64_t bit = 1; mask; bit <<= 1) {
+		if (value & mask & -mask)
+			result |= bit;
+		mask &= mask - 1;
+	}
+	return result;
+#endif
+}
+#endif
+
+void MagicBitboardHelper::GenerateMagics() {
+	// Too big for the stack, and the tables it builds aren't needed for the search.
+	std::unique_ptr<MagicBitboardHelper> generator{ new MagicBitboardHelper(SliderBackend::MAGIC) };
+
+	generator->GenerateOrthogonalMagics();
+	std::cout << '\n';
+	generator->GenerateDiagonalMagics();
+}
+
+MagicBitboardHelper::MagicBitboardHelper(SliderBackend sliderBackend) :
+	m_sliderBackend{sliderBackend},
 	m_rng{}
 {
-	// Uncomment these when doing one-off calculations
-	//GenerateOrthogonalMagics();
-	//GenerateDiagonalMagics();
-
+	// Uncomment these when doing one-off calculations. New magics come from the magicgen target instead.
 	//GenerateKnightAttacks();
 	//GenerateKingAttacks();
 	//GenerateWhitePawnAttacks();
@@ -19,8 +88,11 @@ MagicBitboardHelper::MagicBitboardHelper() :
 	//GenerateBlackKingDefenceMasks();
 
 	// Uncomment these when actually running program!
-	PopulateOrthogonalAttacks();
-	PopulateDiagonalAttacks();
+	// Hyperbola quintessence works the attacks out as it goes, so it needs no tables.
+	if (m_sliderBackend != SliderBackend::HYPERBOLA_QUINTESSENCE) {
+		PopulateOrthogonalAttacks();
+		PopulateDiagonalAttacks();
+	}
 	PopulateBetweenMasks();
 }
 
@@ -59,6 +131,7 @@ void MagicBitboardHelper::GenerateBlackKingDefenceMasks() {
 
 void MagicBitboardHelper::PopulateBetweenMasks(Square square) {
 	std::array<Bitboard, static_cast<size_t>(Square::COUNT)>& betweenMasks = m_betweenMasks[static_cast<size_t>(square)];
+	std::array<Bitboard, static_cast<size_t>(Square::COUNT)>& lineMasks = m_lineMasks[static_cast<size_t>(square)];
 
 	Bitboard squareBB{square};
 
@@ -74,9 +147,16 @@ void MagicBitboardHelper::PopulateBetweenMasks(Square square) {
 
 		if (!orthogonallyAligned && !diagonallyAligned) {
 			betweenMasks[i] = Bitboard{0ULL};
+			lineMasks[i] = Bitboard{0ULL};
 			continue;
 		}
 
+		// Of the four lines through the square, the one the other square is on.
+		for (Bitboard line : { FILE_LINE_MASKS[static_cast<size_t>(square)], RANK_LINE_MASKS[static_cast<size_t>(square)], DIAGONAL_LINE_MASKS[static_cast<size_t>(square)], ANTI_DIAGONAL_LINE_MASKS[static_cast<size_t>(square)] }) {
+			if ((line & otherSquareBB).Any())
+				lineMasks[i] = line | squareBB;
+		}
+
 		if (orthogonallyAligned) {
 
 			Bitboard orthogonalOccupancy = orthogonalOccupancyMask & otherSquareBB;
@@ -213,27 +293,34 @@ void MagicBitboardHelper::GenerateOrthogonalOccupanciesAndAttacks(Square square,
 	} while (occupancy != 0ULL);
 }
 
-uint64_t MagicBitboardHelper::SearchForOrthogonalMagic(const std::vector<Bitboard>& configurations, const std::vector<Bitboard>& moves) {
+uint64_t MagicBitboardHelper::SearchForOrthogonalMagic(Square square, const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets) {
+	Bitboard occupancyMask = GetOrthogonalOccupancyMask(square);
+	size_t shift = ORTHOGONAL_SHIFTS[static_cast<size_t>(square)];
+
+	std::array<bool, ORTHOGONAL_CONFIGURATIONS> used;
+	std::array<Bitboard, ORTHOGONAL_CONFIGURATIONS> attackSetTable;
+
 	uint64_t magic;
 	while (true) {
 		magic = GenerateMagic();
-		bool validMagic = true;
 
-		std::array<bool, ORTHOGONAL_CONFIGURATIONS> used;
-		used.fill(false);
+		// A magic that leaves the top byte of the product sparse hardly ever works, so don't bother trying it.
+		if (Bitboard{ (occupancyMask * magic) & 0xFF00000000000000ULL }.PopCount() < 6)
+			continue;
 
-		std::array<Bitboard, ORTHOGONAL_CONFIGURATIONS> movesets;
+		bool validMagic = true;
+		used.fill(false);
 
-		for (int i = 0; i < configurations.size(); ++i) {
-			Bitboard configuration = configurations[i];
-			Bitboard moveset = moves[i];
+		for (size_t i = 0; i < occupancies.size(); ++i) {
+			Bitboard occupancy = occupancies[i];
+			Bitboard attackSet = attackSets[i];
 
-			size_t index = (configuration * magic) >> ORTHOGONAL_SHIFT;
+			size_t index = (occupancy * magic) >> shift;
 
 			if (!used.at(index)) {
 				used.at(index) = true;
-				movesets.at(i) = moveset;
-			} else if (movesets.at(index) != moveset) {
+				attackSetTable.at(index) = attackSet;
+			} else if (attackSetTable.at(index) != attackSet) {
 				validMagic = false;
 				break;
 			}
@@ -244,20 +331,20 @@ uint64_t MagicBitboardHelper::SearchForOrthogonalMagic(const std::vector<Bitboar
 	}
 }
 
-void MagicBitboardHelper::GenerateOrthogonalMagic(Square square) {
+uint64_t MagicBitboardHelper::GenerateOrthogonalMagic(Square square) {
 	std::vector<Bitboard> occupancies;
 	std::vector<Bitboard> attackSets;
 
 	GenerateOrthogonalOccupanciesAndAttacks(square, occupancies, attackSets);
 
-	uint64_t magic = SearchForOrthogonalMagic(occupancies, attackSets);
-	std::cerr <<  magic << ", ";
+	return SearchForOrthogonalMagic(square, occupancies, attackSets);
 }
 
 void MagicBitboardHelper::GenerateOrthogonalMagics() {
-	#define X(square) GenerateOrthogonalMagic(Square::square);
-	SQUARE_LIST
-	#undef X
+	std::cout << "constexpr std::array<uint64_t, static_cast<size_t>(Square::COUNT)> ORTHOGONAL_MAGICS {\n\t";
+	for (size_t i = 0; i < static_cast<size_t>(Square::COUNT); ++i)
+		std::cout << (i == 0 ? "" : ", ") << GenerateOrthogonalMagic(static_cast<Square>(i)) << "ULL";
+	std::cout << "\n};\n" << std::flush;
 }
 
 void MagicBitboardHelper::PopulateOrthogonalAttacks(Square square) {
@@ -266,13 +353,11 @@ void MagicBitboardHelper::PopulateOrthogonalAttacks(Square square) {
 
 	GenerateOrthogonalOccupanciesAndAttacks(square, occupancies, attackSets);
 
-	std::array<Bitboard, ORTHOGONAL_CONFIGURATIONS>& orthogonalAttacks = m_orthogonalAttacks[static_cast<size_t>(square)];
-	
 	for (size_t i = 0; i < occupancies.size(); ++i) {
 		Bitboard occupancy = occupancies.at(i);
 		Bitboard attackSet = attackSets.at(i);
 
-		orthogonalAttacks[GetOrthogonalIndex(square, occupancy)] = attackSet;
+		m_orthogonalAttacks[GetOrthogonalIndex(square, occupancy)] = attackSet;
 	}
 }
 
@@ -389,26 +474,33 @@ void MagicBitboardHelper::GenerateDiagonalOccupanciesAndAttacks(Square square, s
 	} while (occupancy != 0ULL);
 }
 
-uint64_t MagicBitboardHelper::SearchForDiagonalMagic(const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets) {
+uint64_t MagicBitboardHelper::SearchForDiagonalMagic(Square square, const std::vector<Bitboard>& occupancies, const std::vector<Bitboard>& attackSets) {
+	Bitboard occupancyMask = GetDiagonalOccupancyMask(square);
+	size_t shift = DIAGONAL_SHIFTS[static_cast<size_t>(square)];
+
+	std::array<bool, DIAGONAL_CONFIGURATIONS> used;
+	std::array<Bitboard, DIAGONAL_CONFIGURATIONS> attackSetTable;
+
 	uint64_t magic;
 	while (true) {
 		magic = GenerateMagic();
-		bool validMagic = true;
 
-		std::array<bool, DIAGONAL_CONFIGURATIONS> used;
-		used.fill(false);
+		// A magic that leaves the top byte of the product sparse hardly ever works, so don't bother trying it.
+		if (Bitboard{ (occupancyMask * magic) & 0xFF00000000000000ULL }.PopCount() < 6)
+			continue;
 
-		std::array<Bitboard, DIAGONAL_CONFIGURATIONS> attackSetTable;
+		bool validMagic = true;
+		used.fill(false);
 
-		for (int i = 0; i < occupancies.size(); ++i) {
+		for (size_t i = 0; i < occupancies.size(); ++i) {
 			Bitboard occupancy = occupancies[i];
 			Bitboard attackSet = attackSets[i];
 
-			size_t index = (occupancy * magic) >> DIAGONAL_SHIFT;
+			size_t index = (occupancy * magic) >> shift;
 
 			if (!used.at(index)) {
 				used.at(index) = true;
-				attackSetTable.at(i) = attackSet;
+				attackSetTable.at(index) = attackSet;
 			} else if (attackSetTable.at(index) != attackSet) {
 				validMagic = false;
 				break;
@@ -420,20 +512,20 @@ uint64_t MagicBitboardHelper::SearchForDiagonalMagic(const std::vector<Bitboard>
 	}
 }
 
-void MagicBitboardHelper::GenerateDiagonalMagic(Square square) {
+uint64_t MagicBitboardHelper::GenerateDiagonalMagic(Square square) {
 	std::vector<Bitboard> occupancies;
 	std::vector<Bitboard> attackSets;
 
 	GenerateDiagonalOccupanciesAndAttacks(square, occupancies, attackSets);
 
-	uint64_t magic = SearchForDiagonalMagic(occupancies, attackSets);
-	std::cerr <<  magic << ", ";
+	return SearchForDiagonalMagic(square, occupancies, attackSets);
 }
 
 void MagicBitboardHelper::GenerateDiagonalMagics() {
-	#define X(square) GenerateDiagonalMagic(Square::square);
-	SQUARE_LIST
-	#undef X
+	std::cout << "constexpr std::array<uint64_t, static_cast<size_t>(Square::COUNT)> DIAGONAL_MAGICS {\n\t";
+	for (size_t i = 0; i < static_cast<size_t>(Square::COUNT); ++i)
+		std::cout << (i == 0 ? "" : ", ") << GenerateDiagonalMagic(static_cast<Square>(i)) << "ULL";
+	std::cout << "\n};\n" << std::flush;
 }
 
 void MagicBitboardHelper::PopulateDiagonalAttacks(Square square) {
@@ -442,13 +534,11 @@ void MagicBitboardHelper::PopulateDiagonalAttacks(Square square) {
 
 	GenerateDiagonalOccupanciesAndAttacks(square, occupancies, attackSets);
 
-	std::array<Bitboard, DIAGONAL_CONFIGURATIONS>& diagonalAttacks = m_diagonalAttacks[static_cast<size_t>(square)];
-	
 	for (size_t i = 0; i < occupancies.size(); ++i) {
 		Bitboard occupancy = occupancies.at(i);
 		Bitboard attackSet = attackSets.at(i);
 
-		diagonalAttacks[GetDiagonalIndex(square, occupancy)] = attackSet;
+		m_diagonalAttacks[GetDiagonalIndex(square, occupancy)] = attackSet;
 	}
 }
 
@@ -2,30 +2,34 @@
 
 
 std::string Move::ToString() const {
-	std::string string1 = SquareToString(m_from);
-	std::string string2 = SquareToString(m_to);
+	// UCI spells the null move as 0000, e.g. for the best move when there are no legal moves.
+	if (IsNull())
+		return "0000";
+
+	std::string string1 = SquareToString(GetFrom());
+	std::string string2 = SquareToString(GetTo());
 	std::string string3 = "";
-	if (m_promotionPiece != Piece::EMPTY) {
-		char cPiece = GetChar(m_promotionPiece);
-		string3 += std::tolower(cPiece);
+	if (IsPromotion()) {
+		char cPiece = GetChar(GetPromotionPiece(false));
+		string3 += cPiece;
 	}
 	return string1 + string2 + string3;
 }
 
 std::ostream& operator<<(std::ostream& os, Move move) {
 	os <<
-	move.m_from <<
-	move.m_to <<
+	move.GetFrom() <<
+	move.GetTo() <<
 	' ' <<
-	GetChar(move.m_promotionPiece) <<
+	GetChar(move.GetPromotionPiece(true)) <<
 	' ' <<
-	move.m_isCapture <<
+	move.IsCapture() <<
 	' ' <<
-	move.m_isDoublePawnPush <<
+	move.IsDoublePawnPush() <<
 	' ' <<
-	move.m_isEnPassant <<
+	move.IsEnPassant() <<
 	' ' <<
-	move.m_isCastle <<
+	move.IsCastle() <<
 	'\n';
 	return os;
 }
\ No newline at end of file
@@ -3,70 +3,49 @@
 
 MoveGenerator::MoveGenerator(Board& board) :
 	m_board{board},
-	m_magicBitboardHelper{}
+	m_magicBitboardHelper{MagicBitboardHelper::GetInstance()}
 {}
 
 MoveGenerationContext MoveGenerator::GetMoveGenerationContext() const {
-	const Bitboard* const pBitboards = m_board.GetPieceBitboards();
-
-	const Bitboard* pFriendlyBitboards;
-	const Bitboard* pEnemyBitboards;
-
-	if (m_board.IsWhiteTurn()) {
-		pFriendlyBitboards = pBitboards;
-		pEnemyBitboards = pBitboards + 6;
-	} else {
-		pFriendlyBitboards = pBitboards + 6;
-		pEnemyBitboards = pBitboards;
-	}
+	return m_board.IsWhiteTurn() ? GetMoveGenerationContext<Colour::WHITE>() : GetMoveGenerationContext<Colour::BLACK>();
+}
 
-	Bitboard friendlyPawnBB = *(pFriendlyBitboards);
-	Bitboard friendlyKnightBB = *(pFriendlyBitboards + 1);
-	Bitboard friendlyBishopBB = *(pFriendlyBitboards + 2);
-	Bitboard friendlyRookBB = *(pFriendlyBitboards + 3);
-	Bitboard friendlyQueenBB = *(pFriendlyBitboards + 4);
-	Bitboard friendlyKingBB = *(pFriendlyBitboards + 5);
-
-	Bitboard enemyPawnBB = *(pEnemyBitboards);
-	Bitboard enemyKnightBB = *(pEnemyBitboards + 1);
-	Bitboard enemyBishopBB = *(pEnemyBitboards + 2);
-	Bitboard enemyRookBB = *(pEnemyBitboards + 3);
-	Bitboard enemyQueenBB = *(pEnemyBitboards + 4);
-	Bitboard enemyKingBB = *(pEnemyBitboards + 5);
-
-	Bitboard friendlyPieceBB =
-		friendlyPawnBB 		|
-		friendlyKnightBB 	|
-		friendlyBishopBB 	|
-		friendlyRookBB 		|
-		friendlyQueenBB 	|
-		friendlyKingBB;
-
-	Bitboard enemyPieceBB =
-		enemyPawnBB 	|
-		enemyKnightBB 	|
-		enemyBishopBB 	|
-		enemyRookBB 	|
-		enemyQueenBB 	|
-		enemyKingBB;
+template<Colour Us>
+MoveGenerationContext MoveGenerator::GetMoveGenerationContext() const {
+	constexpr Colour Them = GetOtherColour(Us);
+	using Friendly = ColourTraits<Us>;
+	using Enemy = ColourTraits<Them>;
+
+	Bitboard friendlyPawnBB = m_board.GetPieceBitboard(Friendly::PAWN);
+	Bitboard friendlyKnightBB = m_board.GetPieceBitboard(Friendly::KNIGHT);
+	Bitboard friendlyBishopBB = m_board.GetPieceBitboard(Friendly::BISHOP);
+	Bitboard friendlyRookBB = m_board.GetPieceBitboard(Friendly::ROOK);
+	Bitboard friendlyQueenBB = m_board.GetPieceBitboard(Friendly::QUEEN);
+	Bitboard friendlyKingBB = m_board.GetPieceBitboard(Friendly::KING);
+
+	Bitboard enemyPawnBB = m_board.GetPieceBitboard(Enemy::PAWN);
+	Bitboard enemyKnightBB = m_board.GetPieceBitboard(Enemy::KNIGHT);
+	Bitboard enemyBishopBB = m_board.GetPieceBitboard(Enemy::BISHOP);
+	Bitboard enemyRookBB = m_board.GetPieceBitboard(Enemy::ROOK);
+	Bitboard enemyQueenBB = m_board.GetPieceBitboard(Enemy::QUEEN);
+	Bitboard enemyKingBB = m_board.GetPieceBitboard(Enemy::KING);
+
+	Bitboard friendlyPieceBB = m_board.GetColourBitboard(Us);
+	Bitboard enemyPieceBB = m_board.GetColourBitboard(Them);
 	
 	Square enPassantSquare = m_board.GetEnPassantSquare();
 
-	Bitboard allPieceBB = friendlyPieceBB | enemyPieceBB;
+	Bitboard allPieceBB = m_board.GetAllPieceBitboard();
 	Bitboard emptySquareBB = ~allPieceBB;
 
 	Bitboard enemyOrthogonalPieceBB = enemyRookBB | enemyQueenBB;
 	Bitboard enemyDiagonalPieceBB = enemyBishopBB | enemyQueenBB;
 
-	Bitboard noKingBB = allPieceBB & ~friendlyKingBB;
-
-	Bitboard enemyAttackSetBB = GetAttackSet(enemyPawnBB, enemyKnightBB, enemyBishopBB, enemyRookBB, enemyQueenBB, enemyKingBB, emptySquareBB, noKingBB);
-
 	Square friendlyKingSquare = static_cast<Square>(friendlyKingBB);
 
 	Bitboard checkerBB{0ULL};
 
-	Bitboard kingPawnAttackSet = m_board.IsWhiteTurn() ? m_magicBitboardHelper.GetWhitePawnAttacks(friendlyKingSquare) : m_magicBitboardHelper.GetBlackPawnAttacks(friendlyKingSquare);
+	Bitboard kingPawnAttackSet = m_magicBitboardHelper.GetPawnAttacks<Us>(friendlyKingSquare);
 	checkerBB |= (kingPawnAttackSet & enemyPawnBB);
 
 	Bitboard kingKnightAttackSet = m_magicBitboardHelper.GetKnightAttacks(friendlyKingSquare);
@@ -81,9 +60,7 @@ MoveGenerationContext MoveGenerator::GetMoveGenerationContext() const {
 	checkerBB |= (kingDiagonalAttackSet & enemyDiagonalPieceBB);
 
 	Bitboard checkMaskBB{FULL_BOARD};
-
-	std::array<Bitboard, static_cast<size_t>(Square::COUNT)> pinMasks;
-	pinMasks.fill(FULL_BOARD);
+	Bitboard pinnedBB{0ULL};
 
 	MoveGenerationContext context {
 		friendlyPawnBB,
@@ -104,10 +81,13 @@ MoveGenerationContext MoveGenerator::GetMoveGenerationContext() const {
 		allPieceBB,
 		emptySquareBB,
 		enemyPieceBB,
-		enemyAttackSetBB,
 		checkMaskBB,
-		pinMasks,
-		checkerBB
+		checkerBB,
+		pinnedBB,
+		false,
+		{},
+		Bitboard{0ULL},
+		false
 	};
 
 	return context;
@@ -129,31 +109,133 @@ bool MoveGenerator::IsZugzwangLikely(const MoveGenerationContext& context) const
 	return (inCheck || onlyPawnsAndKing);
 }
 
+bool MoveGenerator::GivesCheck(const Move& move, MoveGenerationContext& context) const {
+	return m_board.IsWhiteTurn() ? GivesCheck<Colour::WHITE>(move, context) : GivesCheck<Colour::BLACK>(move, context);
+}
+
+template<Colour Us>
+void MoveGenerator::SetCheckInfo(MoveGenerationContext& context) const {
+	if (context.m_isCheckInfoSet)
+		return;
+
+	context.m_isCheckInfoSet = true;
+
+	using Traits = ColourTraits<Us>;
+
+	Square enemyKingSquare = static_cast<Square>(context.m_enemyKingBB);
+
+	// Every attack pattern but the pawn's is symmetric, so a piece checks the king from wherever the king would attack it.
+	Bitboard diagonalCheckSquaresBB = m_magicBitboardHelper.GetDiagonalAttacks(enemyKingSquare, GetDiagonalOccupancyMask(enemyKingSquare) & context.m_allPieceBB);
+	Bitboard orthogonalCheckSquaresBB = m_magicBitboardHelper.GetOrthogonalAttacks(enemyKingSquare, GetOrthogonalOccupancyMask(enemyKingSquare) & context.m_allPieceBB);
+
+	context.m_checkSquaresBB[Traits::PAWN - Traits::PAWN] = m_magicBitboardHelper.GetPawnAttacks<GetOtherColour(Us)>(enemyKingSquare);
+	context.m_checkSquaresBB[Traits::KNIGHT - Traits::PAWN] = m_magicBitboardHelper.GetKnightAttacks(enemyKingSquare);
+	context.m_checkSquaresBB[Traits::BISHOP - Traits::PAWN] = diagonalCheckSquaresBB;
+	context.m_checkSquaresBB[Traits::ROOK - Traits::PAWN] = orthogonalCheckSquaresBB;
+	context.m_checkSquaresBB[Traits::QUEEN - Traits::PAWN] = diagonalCheckSquaresBB | orthogonalCheckSquaresBB;
+	context.m_checkSquaresBB[Traits::KING - Traits::PAWN] = Bitboard{0ULL};
+
+	// The same search as for pins, but from the enemy king and with our sliders.
+	Bitboard kingOrthogonalPotentialAttackers = m_magicBitboardHelper.GetOrthogonalRays(enemyKingSquare) & (context.m_friendlyRookBB | context.m_friendlyQueenBB);
+	Bitboard kingDiagonalPotentialAttackers = m_magicBitboardHelper.GetDiagonalRays(enemyKingSquare) & (context.m_friendlyBishopBB | context.m_friendlyQueenBB);
+
+	for (Square potentialAttacker : kingOrthogonalPotentialAttackers | kingDiagonalPotentialAttackers) {
+		Bitboard blockerBB = m_magicBitboardHelper.GetBetweenMask(enemyKingSquare, potentialAttacker) & context.m_allPieceBB;
+
+		if (blockerBB.PopCount() == 1 && (blockerBB & context.m_friendlyPieceBB).Any())
+			context.m_discoveredCheckersBB |= blockerBB;
+	}
+}
+
+template<Colour Us>
+bool MoveGenerator::GivesCheck(const Move& move, MoveGenerationContext& context) const {
+	using Traits = ColourTraits<Us>;
+
+	SetCheckInfo<Us>(context);
+
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+	Bitboard fromBB{from};
+	Bitboard toBB{to};
+
+	Square enemyKingSquare = static_cast<Square>(context.m_enemyKingBB);
+
+	// Uncovering a slider, unless the piece stays on the same line.
+	if ((context.m_discoveredCheckersBB & fromBB).Any() && (m_magicBitboardHelper.GetLineMask(enemyKingSquare, from) & toBB).Empty())
+		return true;
+
+	Piece piece = m_board.GetPieceAtSquare(from);
+
+	if (move.IsPromotion()) {
+		// The pawn's own square is empty by the time the new piece looks along its lines.
+		Piece promotionPiece = move.GetPromotionPiece(Us == Colour::WHITE);
+		Bitboard occupancy = context.m_allPieceBB & ~fromBB;
+
+		switch (promotionPiece) {
+			case Traits::KNIGHT:
+				return (m_magicBitboardHelper.GetKnightAttacks(to) & context.m_enemyKingBB).Any();
+			case Traits::BISHOP:
+				return (m_magicBitboardHelper.GetDiagonalAttacks(to, GetDiagonalOccupancyMask(to) & occupancy) & context.m_enemyKingBB).Any();
+			case Traits::ROOK:
+				return (m_magicBitboardHelper.GetOrthogonalAttacks(to, GetOrthogonalOccupancyMask(to) & occupancy) & context.m_enemyKingBB).Any();
+			default:
+				return ((m_magicBitboardHelper.GetDiagonalAttacks(to, GetDiagonalOccupancyMask(to) & occupancy) | m_magicBitboardHelper.GetOrthogonalAttacks(to, GetOrthogonalOccupancyMask(to) & occupancy)) & context.m_enemyKingBB).Any();
+		}
+	}
+
+	if ((context.m_checkSquaresBB[piece - Traits::PAWN] & toBB).Any())
+		return true;
+
+	if (move.IsEnPassant()) {
+		// Taking two pawns off one rank can open a line that neither of them was blocking on its own.
+		Bitboard occupancy = (context.m_allPieceBB & ~fromBB & ~Traits::ShiftBackward(toBB)) | toBB;
+		Bitboard diagonalAttackersBB = context.m_friendlyBishopBB | context.m_friendlyQueenBB;
+		Bitboard orthogonalAttackersBB = context.m_friendlyRookBB | context.m_friendlyQueenBB;
+
+		return (m_magicBitboardHelper.GetDiagonalAttacks(enemyKingSquare, GetDiagonalOccupancyMask(enemyKingSquare) & occupancy) & diagonalAttackersBB).Any()
+			|| (m_magicBitboardHelper.GetOrthogonalAttacks(enemyKingSquare, GetOrthogonalOccupancyMask(enemyKingSquare) & occupancy) & orthogonalAttackersBB).Any();
+	}
+
+	if (move.IsCastle()) {
+		// Only the rook can give check, from the square it lands on, with the king already moved past it.
+		bool isKingside = (to == Traits::KINGSIDE_CASTLE_SQUARE);
+		Bitboard rookFromBB{isKingside ? Traits::KINGSIDE_ROOK_START_MASK : Traits::QUEENSIDE_ROOK_START_MASK};
+		Bitboard rookToBB{isKingside ? Traits::KINGSIDE_ROOK_END_MASK : Traits::QUEENSIDE_ROOK_END_MASK};
+		Square rookTo = static_cast<Square>(rookToBB);
+
+		Bitboard occupancy = (context.m_allPieceBB & ~fromBB & ~rookFromBB) | toBB | rookToBB;
+
+		return (m_magicBitboardHelper.GetOrthogonalAttacks(rookTo, GetOrthogonalOccupancyMask(rookTo) & occupancy) & context.m_enemyKingBB).Any();
+	}
+
+	return false;
+}
+
 bool MoveGenerator::GenerateMoves(const MoveGenerationParameters& params) const {
 	MoveGenerationContext context = GetMoveGenerationContext();
 
 	return GenerateMoves(params, context);
 }
 
-bool MoveGenerator::GenerateMoves(const MoveGenerationParameters& params, MoveGenerationContext& context) const {
-	params.m_moves.clear();
+void MoveGenerator::SetCheckAndPinMasks(MoveGenerationContext& context) const {
+	if (context.m_areMasksSet)
+		return;
+
+	context.m_areMasksSet = true;
 
 	size_t numCheckers = context.m_checkerBB.PopCount();
-	bool inCheck = numCheckers != 0;
 
-	if (numCheckers == 2) {
-		// If there are two checkers then great. We have sufficient context by this point
-		GenerateKingMoves(params, context);
-		return inCheck;
-	}
+	// With two checkers only the king can move, so neither mask is needed.
+	if (numCheckers == 2)
+		return;
 
 	if (numCheckers == 1) {
 		Square checkerSquare = static_cast<Square>(context.m_checkerBB);
 		context.m_checkMaskBB = m_magicBitboardHelper.GetBetweenMask(context.m_friendlyKingSquare, checkerSquare) | context.m_checkerBB;
 	}
 
-	// Work out pin masks by getting king ray masks, ANDing them with relevant pieces, getting between masks.
-	// If the follow set contains just one piece and it's one of ours, then the mask of allowed squares for that piece is the between mask.
+	// Work out pinned pieces by getting king ray masks, ANDing them with relevant pieces, getting between masks.
+	// If the between mask contains just one piece and it's one of ours, then that piece is pinned to the line.
 	Bitboard kingOrthogonalPotentialAttackers = m_magicBitboardHelper.GetOrthogonalRays(context.m_friendlyKingSquare) & (context.m_enemyRookBB | context.m_enemyQueenBB);
 	Bitboard kingDiagonalPotentialAttackers = m_magicBitboardHelper.GetDiagonalRays(context.m_friendlyKingSquare) & (context.m_enemyBishopBB | context.m_enemyQueenBB);
 
@@ -164,142 +246,208 @@ bool MoveGenerator::GenerateMoves(const MoveGenerationParameters& params, MoveGe
 		Bitboard blockerBB = pinBB & context.m_allPieceBB;
 
 		size_t numBlockers = blockerBB.PopCount();
-		if (numBlockers == 1 && (blockerBB & context.m_friendlyPieceBB).Any()) {
-			Square blocker = static_cast<Square>(blockerBB);
-			context.m_pinMasks[static_cast<size_t>(blocker)] &= pinBB | Bitboard{potentialAttacker};
-		}
+		if (numBlockers == 1 && (blockerBB & context.m_friendlyPieceBB).Any())
+			context.m_pinnedBB |= blockerBB;
+	}
+}
+
+bool MoveGenerator::GenerateMoves(const MoveGenerationParameters& params, MoveGenerationContext& context) const {
+	return m_board.IsWhiteTurn() ? GenerateMoves<Colour::WHITE>(params, context) : GenerateMoves<Colour::BLACK>(params, context);
+}
+
+template<Colour Us>
+bool MoveGenerator::GenerateMoves(const MoveGenerationParameters& params, MoveGenerationContext& context) const {
+	params.m_moves.clear();
+
+	size_t numCheckers = context.m_checkerBB.PopCount();
+	bool inCheck = numCheckers != 0;
+
+	if (numCheckers == 2) {
+		// If there are two checkers then great. We have sufficient context by this point
+		GenerateKingMoves<Us>(params, context);
+		return inCheck;
+	}
+
+	SetCheckAndPinMasks(context);
+
+	if (inCheck) {
+		GenerateEvasions<Us>(params, context);
+		return inCheck;
 	}
 
-	GeneratePawnMoves(params, context);
+	GeneratePawnMoves<Us>(params, context);
 	GenerateKnightMoves(params, context);
 	GenerateBishopMoves(params, context);
 	GenerateRookMoves(params, context);
 	GenerateQueenMoves(params, context);
-	GenerateKingMoves(params, context);
-
-	if (numCheckers == 0)
-		GenerateCastleMoves(params, context);
+	GenerateKingMoves<Us>(params, context);
+	GenerateCastleMoves<Us>(params, context);
 
 	return inCheck;
 }
 
-inline void MoveGenerator::GeneratePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	if (m_board.IsWhiteTurn()) {
-		GenerateWhitePawnMoves(params, context);
-	} else {
-		GenerateBlackPawnMoves(params, context);
+template<Colour Us>
+void MoveGenerator::GenerateEvasions(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
+	// A pinned piece can only move along its pin, which never takes or blocks a checker on another line, so pinned
+	// pieces sit this out. Of the rest, only pieces that could reach the check mask on an empty board are looked at.
+	Bitboard knightReachBB{0ULL};
+	Bitboard diagonalReachBB{0ULL};
+	Bitboard orthogonalReachBB{0ULL};
+
+	for (Square target : context.m_checkMaskBB) {
+		knightReachBB |= m_magicBitboardHelper.GetKnightAttacks(target);
+		diagonalReachBB |= m_magicBitboardHelper.GetDiagonalRays(target);
+		orthogonalReachBB |= m_magicBitboardHelper.GetOrthogonalRays(target);
 	}
+
+	Bitboard unpinnedBB = ~context.m_pinnedBB;
+
+	MoveGenerationContext evasionContext = context;
+	evasionContext.m_friendlyPawnBB &= unpinnedBB;
+	evasionContext.m_friendlyKnightBB &= unpinnedBB & knightReachBB;
+	evasionContext.m_friendlyBishopBB &= unpinnedBB & diagonalReachBB;
+	evasionContext.m_friendlyRookBB &= unpinnedBB & orthogonalReachBB;
+	evasionContext.m_friendlyQueenBB &= unpinnedBB & (diagonalReachBB | orthogonalReachBB);
+
+	GeneratePawnMoves<Us>(params, evasionContext);
+	GenerateKnightMoves(params, evasionContext);
+	GenerateBishopMoves(params, evasionContext);
+	GenerateRookMoves(params, evasionContext);
+	GenerateQueenMoves(params, evasionContext);
+	GenerateKingMoves<Us>(params, context);
 }
 
-inline void MoveGenerator::GenerateWhitePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	for (Square pawnSquare : context.m_friendlyPawnBB) {
-		Bitboard pawnBB{pawnSquare};
+bool MoveGenerator::IsPseudoLegal(const Move& move, const MoveGenerationContext& context) const {
+	return m_board.IsWhiteTurn() ? IsPseudoLegal<Colour::WHITE>(move, context) : IsPseudoLegal<Colour::BLACK>(move, context);
+}
 
-		Bitboard attackSetBB = m_magicBitboardHelper.GetWhitePawnAttacks(pawnSquare);
+bool MoveGenerator::IsLegal(const Move& move, MoveGenerationContext& context) const {
+	return m_board.IsWhiteTurn() ? IsLegal<Colour::WHITE>(move, context) : IsLegal<Colour::BLACK>(move, context);
+}
 
-		// En passant
-		Bitboard enPassantBB = attackSetBB & Bitboard{context.m_enPassantSquare};
-		if (context.m_enPassantSquare != Square::NONE && enPassantBB.Any()) {
-			// Can we just use XOR below?
-			Bitboard removedPawnBB = context.m_allPieceBB & ~pawnBB & ~enPassantBB.ShiftSouth() | enPassantBB;
+template<Colour Us>
+bool MoveGenerator::IsPseudoLegal(const Move& move, const MoveGenerationContext& context) const {
+	using Traits = ColourTraits<Us>;
 
-			Bitboard enemyOrthogonalsBB = context.m_enemyRookBB | context.m_enemyQueenBB;
-			Bitboard orthogonalOccupancy = GetOrthogonalOccupancyMask(context.m_friendlyKingSquare) & removedPawnBB;
-			Bitboard orthogonalAttackers = m_magicBitboardHelper.GetOrthogonalAttacks(context.m_friendlyKingSquare, orthogonalOccupancy) & enemyOrthogonalsBB;
+	if (move.IsNull() || !move.HasValidFlag())
+		return false;
 
-			if (orthogonalAttackers.Empty()) {
-				Bitboard enemyDiagonalsBB = context.m_enemyBishopBB | context.m_enemyQueenBB;
-				Bitboard diagonalOccupancy = GetDiagonalOccupancyMask(context.m_friendlyKingSquare) & removedPawnBB;
-				Bitboard diagonalAttackers = m_magicBitboardHelper.GetDiagonalAttacks(context.m_friendlyKingSquare, diagonalOccupancy) & enemyDiagonalsBB;
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+	Bitboard fromBB{from};
+	Bitboard toBB{to};
 
-				if (diagonalAttackers.Empty()) {
-					int mvv_lva = ABSOLUTE_PIECE_VALUES[Piece::BLACK_PAWN] * 10 - ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN];
-					params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, context.m_enPassantSquare, Piece::EMPTY, false, false, true, false});
-				}
-			}
-		}
+	if ((fromBB & context.m_friendlyPieceBB).Empty())
+		return false;
 
-		// Captures
-		Bitboard captureBB = attackSetBB & context.m_enemyPieceBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
-		if ((pawnBB & RANK_7).Any()) {
-			for (Square to : captureBB) {
-				Piece victim = m_board.GetPieceAtSquare(to);
-				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN];
+	Piece piece = m_board.GetPieceAtSquare(from);
 
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::WHITE_KNIGHT, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::WHITE_BISHOP, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::WHITE_ROOK, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::WHITE_QUEEN, true, false, false, false});
-			}
-		} else {
-			for (Square to : captureBB) {
-				Piece victim = m_board.GetPieceAtSquare(to);
-				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN];
+	// Castling is checked in full here, including the squares the king passes through, since IsLegal only looks at where it lands.
+	if (move.IsCastle()) {
+		if ((piece != Traits::KING) || context.m_checkerBB.Any())
+			return false;
 
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::EMPTY, true, false, false, false});
-			}
+		if (to == Traits::KINGSIDE_CASTLE_SQUARE) {
+			return m_board.GetCastlePermission(Traits::KINGSIDE)
+				&& (context.m_allPieceBB & Traits::KINGSIDE_CASTLE_SPACE_MASK).Empty()
+				&& !IsAnyAttackedByEnemy<Us>(context, Traits::KINGSIDE_CASTLE_CHECKS_MASK);
 		}
 
-		if (params.m_capturesOnly)
-			continue;
+		if (to == Traits::QUEENSIDE_CASTLE_SQUARE) {
+			return m_board.GetCastlePermission(Traits::QUEENSIDE)
+				&& (context.m_allPieceBB & Traits::QUEENSIDE_CASTLE_SPACE_MASK).Empty()
+				&& !IsAnyAttackedByEnemy<Us>(context, Traits::QUEENSIDE_CASTLE_CHECKS_MASK);
+		}
 
-		// Quiet moves
-		Bitboard pawnPushBB = pawnBB.ShiftNorth() & context.m_emptySquareBB;
+		return false;
+	}
 
-		if (pawnPushBB.Empty())
-			continue;
+	if (move.IsEnPassant())
+		return (piece == Traits::PAWN) && (to == context.m_enPassantSquare) && (m_magicBitboardHelper.GetPawnAttacks<Us>(from) & toBB).Any();
 
-		Bitboard pawnPushAllowedBB = pawnPushBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
+	// The flag has to agree with what is on the to square.
+	if (move.IsCapture() ? (toBB & context.m_enemyPieceBB).Empty() : (toBB & context.m_emptySquareBB).Empty())
+		return false;
 
-		if (pawnPushAllowedBB.Any()) {
-			Square pawnPushSquare = static_cast<Square>(pawnPushBB);
-			if ((pawnPushBB & RANK_8).Any()) {
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_KNIGHT], pawnSquare, pawnPushSquare, Piece::WHITE_KNIGHT, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_BISHOP], pawnSquare, pawnPushSquare, Piece::WHITE_BISHOP, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_ROOK], pawnSquare, pawnPushSquare, Piece::WHITE_ROOK, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_QUEEN], pawnSquare, pawnPushSquare, Piece::WHITE_QUEEN, false, false, false, false});
-				continue;
-			} else {
-				params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, pawnSquare, pawnPushSquare, Piece::EMPTY, false, false, false, false});
-			}
-		}
+	if (piece == Traits::PAWN) {
+		if (move.IsPromotion() != (fromBB & Traits::PROMOTION_RANK_MASK).Any())
+			return false;
 
-		if ((pawnBB & RANK_2).Empty())
-			continue;
+		if (move.IsCapture())
+			return (m_magicBitboardHelper.GetPawnAttacks<Us>(from) & toBB).Any();
 
-		Bitboard pawnPushPushBB = pawnPushBB.ShiftNorth() & context.m_emptySquareBB;
-		
-		if (pawnPushPushBB.Empty())
-			continue;
+		Bitboard pawnPushBB = Traits::ShiftForward(fromBB);
 
-		Bitboard pawnPushPushAllowedBB = pawnPushPushBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
-		
-		if (pawnPushPushAllowedBB.Any()) {
-			Square pawnPushPushSquare = static_cast<Square>(pawnPushPushBB);
+		if (move.IsDoublePawnPush())
+			return (fromBB & Traits::DOUBLE_PUSH_RANK_MASK).Any() && (pawnPushBB & context.m_emptySquareBB).Any() && (Traits::ShiftForward(pawnPushBB) == toBB);
 
-			if ((pawnPushPushBB & RANK_8).Any()) {
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_KNIGHT], pawnSquare, pawnPushPushSquare, Piece::WHITE_KNIGHT, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_BISHOP], pawnSquare, pawnPushPushSquare, Piece::WHITE_BISHOP, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_ROOK], pawnSquare, pawnPushPushSquare, Piece::WHITE_ROOK, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::WHITE_QUEEN], pawnSquare, pawnPushPushSquare, Piece::WHITE_QUEEN, false, true, false, false});
-			} else {
-				params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, pawnSquare, pawnPushPushSquare, Piece::EMPTY, false, true, false, false});
-			}
-		}
+		return pawnPushBB == toBB;
+	}
+
+	if (move.IsPromotion() || move.IsDoublePawnPush())
+		return false;
+
+	switch (piece) {
+		case Traits::KNIGHT:
+			return (m_magicBitboardHelper.GetKnightAttacks(from) & toBB).Any();
+		case Traits::BISHOP:
+			return (m_magicBitboardHelper.GetDiagonalAttacks(from, GetDiagonalOccupancyMask(from) & context.m_allPieceBB) & toBB).Any();
+		case Traits::ROOK:
+			return (m_magicBitboardHelper.GetOrthogonalAttacks(from, GetOrthogonalOccupancyMask(from) & context.m_allPieceBB) & toBB).Any();
+		case Traits::QUEEN:
+			return ((m_magicBitboardHelper.GetDiagonalAttacks(from, GetDiagonalOccupancyMask(from) & context.m_allPieceBB) | m_magicBitboardHelper.GetOrthogonalAttacks(from, GetOrthogonalOccupancyMask(from) & context.m_allPieceBB)) & toBB).Any();
+		default:
+			return (m_magicBitboardHelper.GetKingAttacks(from) & toBB).Any();
 	}
 }
 
-inline void MoveGenerator::GenerateBlackPawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
+template<Colour Us>
+bool MoveGenerator::IsLegal(const Move& move, MoveGenerationContext& context) const {
+	using Traits = ColourTraits<Us>;
+
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+
+	if (from == context.m_friendlyKingSquare)
+		return !IsAttackedByEnemy<Us>(context, to, context.m_allPieceBB & ~context.m_friendlyKingBB);
+
+	if (context.m_checkerBB.PopCount() == 2)
+		return false;
+
+	if (move.IsEnPassant()) {
+		// Both pawns leave the same rank at once, so the king has to be looked at again with them gone.
+		Bitboard toBB{to};
+		Bitboard capturedBB = Traits::ShiftBackward(toBB);
+		Bitboard occupancy = (context.m_allPieceBB & ~Bitboard{from} & ~capturedBB) | toBB;
+
+		Bitboard enemyDiagonalsBB = context.m_enemyBishopBB | context.m_enemyQueenBB;
+		Bitboard enemyOrthogonalsBB = context.m_enemyRookBB | context.m_enemyQueenBB;
+
+		return (m_magicBitboardHelper.GetDiagonalAttacks(context.m_friendlyKingSquare, GetDiagonalOccupancyMask(context.m_friendlyKingSquare) & occupancy) & enemyDiagonalsBB).Empty()
+			&& (m_magicBitboardHelper.GetOrthogonalAttacks(context.m_friendlyKingSquare, GetOrthogonalOccupancyMask(context.m_friendlyKingSquare) & occupancy) & enemyOrthogonalsBB).Empty()
+			&& (context.m_checkerBB & ~capturedBB & (context.m_enemyPawnBB | context.m_enemyKnightBB)).Empty();
+	}
+
+	SetCheckAndPinMasks(context);
+
+	return (Bitboard{to} & context.m_checkMaskBB & GetPinMask(context, from)).Any();
+}
+
+template<Colour Us>
+inline void MoveGenerator::GeneratePawnMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
+	using Traits = ColourTraits<Us>;
+
 	for (Square pawnSquare : context.m_friendlyPawnBB) {
 		Bitboard pawnBB{pawnSquare};
+		Bitboard pinMaskBB = GetPinMask(context, pawnSquare);
 
-		Bitboard attackSetBB = m_magicBitboardHelper.GetBlackPawnAttacks(pawnSquare);
+		Bitboard attackSetBB = m_magicBitboardHelper.GetPawnAttacks<Us>(pawnSquare);
 
 		// En passant
 		Bitboard enPassantBB = attackSetBB & Bitboard{context.m_enPassantSquare};
-		if (context.m_enPassantSquare != Square::NONE && enPassantBB.Any()) {
+		if (params.IncludesCaptures() && context.m_enPassantSquare != Square::NONE && enPassantBB.Any()) {
 			// Can we just use XOR below?
-			Bitboard removedPawnBB = context.m_allPieceBB & ~pawnBB & ~enPassantBB.ShiftNorth() | enPassantBB;
+			Bitboard removedPawnBB = context.m_allPieceBB & ~pawnBB & ~Traits::ShiftBackward(enPassantBB) | enPassantBB;
 
 			Bitboard enemyOrthogonalsBB = context.m_enemyRookBB | context.m_enemyQueenBB;
 			Bitboard orthogonalOccupancy = GetOrthogonalOccupancyMask(context.m_friendlyKingSquare) & removedPawnBB;
@@ -311,100 +459,98 @@ inline void MoveGenerator::GenerateBlackPawnMoves(const MoveGenerationParameters
 				Bitboard diagonalAttackers = m_magicBitboardHelper.GetDiagonalAttacks(context.m_friendlyKingSquare, diagonalOccupancy) & enemyDiagonalsBB;
 
 				if (diagonalAttackers.Empty()) {
-					int mvv_lva = ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN] * 10 - ABSOLUTE_PIECE_VALUES[Piece::BLACK_PAWN];
-					params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, context.m_enPassantSquare, Piece::EMPTY, false, false, true, false});
+					int mvv_lva = ABSOLUTE_PIECE_VALUES[ColourTraits<GetOtherColour(Us)>::PAWN] * 10 - ABSOLUTE_PIECE_VALUES[Traits::PAWN];
+					params.m_moves.push_back(Move{pawnSquare, context.m_enPassantSquare, MoveFlag::EN_PASSANT}, CAPTURE_BASE_SCORE + mvv_lva);
 				}
 			}
 		}
 
+		bool isPromoting = (pawnBB & Traits::PROMOTION_RANK_MASK).Any();
+
 		// Captures
-		Bitboard captureBB = attackSetBB & context.m_enemyPieceBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
-		if ((pawnBB & RANK_2).Any()) {
+		Bitboard captureBB = attackSetBB & context.m_enemyPieceBB & params.GetCaptureMask() & context.m_checkMaskBB & pinMaskBB;
+		if (isPromoting) {
 			for (Square to : captureBB) {
 				Piece victim = m_board.GetPieceAtSquare(to);
-				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Piece::BLACK_PAWN];
+				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Traits::PAWN];
 
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::BLACK_KNIGHT, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::BLACK_BISHOP, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::BLACK_ROOK, true, false, false, false});
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::BLACK_QUEEN, true, false, false, false});
+				params.m_moves.push_back(Move{pawnSquare, to, Traits::KNIGHT, true}, CAPTURE_BASE_SCORE + mvv_lva);
+				params.m_moves.push_back(Move{pawnSquare, to, Traits::BISHOP, true}, CAPTURE_BASE_SCORE + mvv_lva);
+				params.m_moves.push_back(Move{pawnSquare, to, Traits::ROOK, true}, CAPTURE_BASE_SCORE + mvv_lva);
+				params.m_moves.push_back(Move{pawnSquare, to, Traits::QUEEN, true}, CAPTURE_BASE_SCORE + mvv_lva);
 			}
 		} else {
 			for (Square to : captureBB) {
 				Piece victim = m_board.GetPieceAtSquare(to);
-				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Piece::BLACK_PAWN];
+				int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[Traits::PAWN];
 
-				params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, pawnSquare, to, Piece::EMPTY, true, false, false, false});
+				params.m_moves.push_back(Move{pawnSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 			}
 		}
 
-		if (params.m_capturesOnly)
+		if (!params.IncludesQuiets())
 			continue;
 
 		// Quiet moves
-		Bitboard pawnPushBB = pawnBB.ShiftSouth() & context.m_emptySquareBB;
+		Bitboard pawnPushBB = Traits::ShiftForward(pawnBB) & context.m_emptySquareBB;
+
+		if (pawnPushBB.Empty())
+			continue;
 
-		Bitboard pawnPushAllowedBB = pawnPushBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
+		Bitboard pawnPushAllowedBB = pawnPushBB & context.m_checkMaskBB & pinMaskBB;
 
 		if (pawnPushAllowedBB.Any()) {
 			Square pawnPushSquare = static_cast<Square>(pawnPushBB);
-			if ((pawnPushBB & RANK_1).Any()) {
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_KNIGHT], pawnSquare, pawnPushSquare, Piece::BLACK_KNIGHT, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_BISHOP], pawnSquare, pawnPushSquare, Piece::BLACK_BISHOP, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_ROOK], pawnSquare, pawnPushSquare, Piece::BLACK_ROOK, false, false, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_QUEEN], pawnSquare, pawnPushSquare, Piece::BLACK_QUEEN, false, false, false, false});
+			if (isPromoting) {
+				params.m_moves.push_back(Move{pawnSquare, pawnPushSquare, Traits::KNIGHT, false}, PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Traits::KNIGHT]);
+				params.m_moves.push_back(Move{pawnSquare, pawnPushSquare, Traits::BISHOP, false}, PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Traits::BISHOP]);
+				params.m_moves.push_back(Move{pawnSquare, pawnPushSquare, Traits::ROOK, false}, PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Traits::ROOK]);
+				params.m_moves.push_back(Move{pawnSquare, pawnPushSquare, Traits::QUEEN, false}, PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Traits::QUEEN]);
 				continue;
 			} else {
-				params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, pawnSquare, pawnPushSquare, Piece::EMPTY, false, false, false, false});
+				params.m_moves.push_back(Move{pawnSquare, pawnPushSquare}, QUIET_MOVE_BASE_SCORE);
 			}
 		}
 
-		if ((pawnBB & RANK_7).Empty())
+		if ((pawnBB & Traits::DOUBLE_PUSH_RANK_MASK).Empty())
 			continue;
 
-		Bitboard pawnPushPushBB = pawnPushBB.ShiftSouth() & context.m_emptySquareBB;
-
+		Bitboard pawnPushPushBB = Traits::ShiftForward(pawnPushBB) & context.m_emptySquareBB;
+		
 		if (pawnPushPushBB.Empty())
 			continue;
 
-		Bitboard pawnPushPushAllowedBB = pawnPushPushBB & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(pawnSquare)];
-
+		Bitboard pawnPushPushAllowedBB = pawnPushPushBB & context.m_checkMaskBB & pinMaskBB;
+		
 		if (pawnPushPushAllowedBB.Any()) {
 			Square pawnPushPushSquare = static_cast<Square>(pawnPushPushBB);
-			if ((pawnPushPushBB & RANK_1).Any()) {
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_KNIGHT], pawnSquare, pawnPushPushSquare, Piece::BLACK_KNIGHT, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_BISHOP], pawnSquare, pawnPushPushSquare, Piece::BLACK_BISHOP, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_ROOK], pawnSquare, pawnPushPushSquare, Piece::BLACK_ROOK, false, true, false, false});
-				params.m_moves.push_back(Move{PROMOTION_BASE_SCORE + ABSOLUTE_PIECE_VALUES[Piece::BLACK_QUEEN], pawnSquare, pawnPushPushSquare, Piece::BLACK_QUEEN, false, true, false, false});
-			} else {
-				params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, pawnSquare, pawnPushPushSquare, Piece::EMPTY, false, true, false, false});
-			}
+
+			params.m_moves.push_back(Move{pawnSquare, pawnPushPushSquare, MoveFlag::DOUBLE_PAWN_PUSH}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
 
 inline void MoveGenerator::GenerateKnightMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	for (Square knightSquare : context.m_friendlyKnightBB) {
-		if (knightSquare == Square::NONE) continue;
-
+	// A pinned knight can never stay on the line it's pinned to.
+	for (Square knightSquare : context.m_friendlyKnightBB & ~context.m_pinnedBB) {
 		Bitboard attackSet = m_magicBitboardHelper.GetKnightAttacks(knightSquare);
 
-		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(knightSquare)];
+		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB;
 
-		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB;
+		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB & params.GetCaptureMask();
 		for (Square to : captureBB) {
 			Piece victim = m_board.GetPieceAtSquare(to);
 			int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[WHITE_KNIGHT];
 
-			params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, knightSquare, to, Piece::EMPTY, true, false, false, false});
+			params.m_moves.push_back(Move{knightSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 		}
 
-		if (params.m_capturesOnly)
+		if (!params.IncludesQuiets())
 			continue;
 
 		Bitboard quietMoveBB = possibleMoveBB & context.m_emptySquareBB;
 		for (Square to : quietMoveBB) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, knightSquare, to, Piece::EMPTY, false, false, false, false});
+			params.m_moves.push_back(Move{knightSquare, to}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
@@ -416,22 +562,22 @@ inline void MoveGenerator::GenerateBishopMoves(const MoveGenerationParameters& p
 
 		Bitboard attackSet = m_magicBitboardHelper.GetDiagonalAttacks(bishopSquare, occupancy);
 
-		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(bishopSquare)];
+		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & GetPinMask(context, bishopSquare);
 
-		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB;
+		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB & params.GetCaptureMask();
 		for (Square to : captureBB) {
 			Piece victim = m_board.GetPieceAtSquare(to);
 			int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[WHITE_BISHOP];
 
-			params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, bishopSquare, to, Piece::EMPTY, true, false, false, false});
+			params.m_moves.push_back(Move{bishopSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 		}
 
-		if (params.m_capturesOnly)
+		if (!params.IncludesQuiets())
 			continue;
 
 		Bitboard quietMoveBB = possibleMoveBB & context.m_emptySquareBB;
 		for (Square to : quietMoveBB) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, bishopSquare, to, Piece::EMPTY, false, false, false, false});
+			params.m_moves.push_back(Move{bishopSquare, to}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
@@ -443,22 +589,22 @@ inline void MoveGenerator::GenerateRookMoves(const MoveGenerationParameters& par
 
 		Bitboard attackSet = m_magicBitboardHelper.GetOrthogonalAttacks(rookSquare, occupancy);
 
-		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(rookSquare)];
+		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & GetPinMask(context, rookSquare);
 
-		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB;
+		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB & params.GetCaptureMask();
 		for (Square to : captureBB) {
 			Piece victim = m_board.GetPieceAtSquare(to);
 			int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[WHITE_ROOK];
 
-			params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, rookSquare, to, Piece::EMPTY, true, false, false, false});
+			params.m_moves.push_back(Move{rookSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 		}
 
-		if (params.m_capturesOnly)
+		if (!params.IncludesQuiets())
 			continue;
 
 		Bitboard quietMoveBB = possibleMoveBB & context.m_emptySquareBB;
 		for (Square to : quietMoveBB) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, rookSquare, to, Piece::EMPTY, false, false, false, false});
+			params.m_moves.push_back(Move{rookSquare, to}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
@@ -476,194 +622,212 @@ inline void MoveGenerator::GenerateQueenMoves(const MoveGenerationParameters& pa
 
 		Bitboard attackSet = orthogonalAttackSet | diagonalAttackSet;
 
-		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & context.m_pinMasks[static_cast<size_t>(queenSquare)];
+		Bitboard possibleMoveBB = attackSet & context.m_checkMaskBB & GetPinMask(context, queenSquare);
 
-		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB;
+		Bitboard captureBB = possibleMoveBB & context.m_enemyPieceBB & params.GetCaptureMask();
 		for (Square to : captureBB) {
 			Piece victim = m_board.GetPieceAtSquare(to);
 			int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[WHITE_QUEEN];
 
-			params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, queenSquare, to, Piece::EMPTY, true, false, false, false});
+			params.m_moves.push_back(Move{queenSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 		}
 
-		if (params.m_capturesOnly)
+		if (!params.IncludesQuiets())
 			continue;
 
 		Bitboard quietMoveBB = possibleMoveBB & context.m_emptySquareBB;
 		for (Square to : quietMoveBB) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, queenSquare, to, Piece::EMPTY, false, false, false, false});
+			params.m_moves.push_back(Move{queenSquare, to}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
 
+template<Colour Us>
 inline void MoveGenerator::GenerateKingMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
 	Bitboard attackSetBB = m_magicBitboardHelper.GetKingAttacks(context.m_friendlyKingSquare);
 
-	Bitboard possibleMoveBB = attackSetBB & ~context.m_enemyAttackSet;
+	// The king mustn't hide behind itself from a slider, so it is taken off the board for the attack checks.
+	Bitboard noKingBB = context.m_allPieceBB & ~context.m_friendlyKingBB;
 
-	Bitboard captures = possibleMoveBB & context.m_enemyPieceBB;
+	Bitboard captures = attackSetBB & context.m_enemyPieceBB & params.GetCaptureMask();
 	for (Square to : captures) {
+		if (IsAttackedByEnemy<Us>(context, to, noKingBB))
+			continue;
+
 		Piece victim = m_board.GetPieceAtSquare(to);
 		int mvv_lva = ABSOLUTE_PIECE_VALUES[victim] * 10 - ABSOLUTE_PIECE_VALUES[WHITE_KING];
-		params.m_moves.push_back(Move{CAPTURE_BASE_SCORE + mvv_lva, context.m_friendlyKingSquare, to, Piece::EMPTY, true, false, false, false});
+		params.m_moves.push_back(Move{context.m_friendlyKingSquare, to, MoveFlag::CAPTURE}, CAPTURE_BASE_SCORE + mvv_lva);
 	}
 
-	if (params.m_capturesOnly)
+	if (!params.IncludesQuiets())
 			return;
 		
-	Bitboard quietMoves = possibleMoveBB & context.m_emptySquareBB;
+	Bitboard quietMoves = attackSetBB & context.m_emptySquareBB;
 	for (Square to : quietMoves) {
-		params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, context.m_friendlyKingSquare, to, Piece::EMPTY, false, false, false, false});
+		if (IsAttackedByEnemy<Us>(context, to, noKingBB))
+			continue;
+
+		params.m_moves.push_back(Move{context.m_friendlyKingSquare, to}, QUIET_MOVE_BASE_SCORE);
 	}
 
 }
 
+template<Colour Us>
 inline void MoveGenerator::GenerateCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	if (params.m_capturesOnly)
-		return;
+	using Traits = ColourTraits<Us>;
 
-	if (m_board.IsWhiteTurn())
-		GenerateWhiteCastleMoves(params, context);
-	else
-		GenerateBlackCastleMoves(params, context);
-}
+	if (!params.IncludesQuiets())
+		return;
 
-void MoveGenerator::GenerateWhiteCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	if (m_board.GetCastlePermission(CastlePermission::WHITE_KINGSIDE)) {
-		bool isKingsideClear = (context.m_allPieceBB & WHITE_KINGSIDE_CASTLE_SPACE_MASK).Empty();
-		bool isNotThroughCheck = (context.m_enemyAttackSet & WHITE_KINGSIDE_CASTLE_CHECKS_MASK).Empty();
-		if (isKingsideClear && isNotThroughCheck) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, context.m_friendlyKingSquare, Square::g1, Piece::EMPTY, false, false, false, true});
+	if (m_board.GetCastlePermission(Traits::KINGSIDE)) {
+		bool isKingsideClear = (context.m_allPieceBB & Traits::KINGSIDE_CASTLE_SPACE_MASK).Empty();
+		if (isKingsideClear && !IsAnyAttackedByEnemy<Us>(context, Traits::KINGSIDE_CASTLE_CHECKS_MASK)) {
+			params.m_moves.push_back(Move{context.m_friendlyKingSquare, Traits::KINGSIDE_CASTLE_SQUARE, MoveFlag::CASTLE}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 
-	if (m_board.GetCastlePermission(CastlePermission::WHITE_QUEENSIDE)) {
-		bool isQueensideClear = (context.m_allPieceBB & WHITE_QUEENSIDE_CASTLE_SPACE_MASK).Empty();
-		bool isNotThroughCheck = (context.m_enemyAttackSet & WHITE_QUEENSIDE_CASTLE_CHECKS_MASK).Empty();
-		if (isQueensideClear && isNotThroughCheck) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, context.m_friendlyKingSquare, Square::c1, Piece::EMPTY, false, false, false, true});
+	if (m_board.GetCastlePermission(Traits::QUEENSIDE)) {
+		bool isQueensideClear = (context.m_allPieceBB & Traits::QUEENSIDE_CASTLE_SPACE_MASK).Empty();
+		if (isQueensideClear && !IsAnyAttackedByEnemy<Us>(context, Traits::QUEENSIDE_CASTLE_CHECKS_MASK)) {
+			params.m_moves.push_back(Move{context.m_friendlyKingSquare, Traits::QUEENSIDE_CASTLE_SQUARE, MoveFlag::CASTLE}, QUIET_MOVE_BASE_SCORE);
 		}
 	}
 }
 
-void MoveGenerator::GenerateBlackCastleMoves(const MoveGenerationParameters& params, const MoveGenerationContext& context) const {
-	if (m_board.GetCastlePermission(CastlePermission::BLACK_KINGSIDE)) {
-		bool isKingsideClear = (context.m_allPieceBB & BLACK_KINGSIDE_CASTLE_SPACE_MASK).Empty();
-		bool isNotThroughCheck = (context.m_enemyAttackSet & BLACK_KINGSIDE_CASTLE_CHECKS_MASK).Empty();
-		if (isKingsideClear && isNotThroughCheck) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, context.m_friendlyKingSquare, Square::g8, Piece::EMPTY, false, false, false, true});
-		}
-	}
+template<Colour Us>
+bool MoveGenerator::IsAttackedByEnemy(const MoveGenerationContext& context, Square square, Bitboard occupancy) const {
+	// Pawns and knights attack back along the same pattern, and so do sliders.
+	if ((m_magicBitboardHelper.GetPawnAttacks<Us>(square) & context.m_enemyPawnBB).Any())
+		return true;
 
-	if (m_board.GetCastlePermission(CastlePermission::BLACK_QUEENSIDE)) {
-		bool isQueensideClear = (context.m_allPieceBB & BLACK_QUEENSIDE_CASTLE_SPACE_MASK).Empty();
-		bool isNotThroughCheck = (context.m_enemyAttackSet & BLACK_QUEENSIDE_CASTLE_CHECKS_MASK).Empty();
-		if (isQueensideClear && isNotThroughCheck) {
-			params.m_moves.push_back(Move{QUIET_MOVE_BASE_SCORE, context.m_friendlyKingSquare, Square::c8, Piece::EMPTY, false, false, false, true});
-		}
-	}
-}
-
-Bitboard MoveGenerator::GetAttackSet(Bitboard pawnBB, Bitboard knightBB, Bitboard bishopBB, Bitboard rookBB, Bitboard queenBB, Bitboard kingBB, Bitboard emptySquareBB, Bitboard allPieceBB) const {
-	Bitboard attackSet = 0ULL;
+	if ((m_magicBitboardHelper.GetKnightAttacks(square) & context.m_enemyKnightBB).Any())
+		return true;
 
-	if (m_board.IsWhiteTurn())
-		attackSet |= GetBlackPawnAttackSet(pawnBB);
-	else
-		attackSet |= GetWhitePawnAttackSet(pawnBB);
+	if ((m_magicBitboardHelper.GetKingAttacks(square) & context.m_enemyKingBB).Any())
+		return true;
 
-	attackSet |= GetKnightAttackSet(knightBB);
-	attackSet |= GetBishopAttackSet(bishopBB, allPieceBB);
-	attackSet |= GetRookAttackSet(rookBB, allPieceBB);
-	attackSet |= GetQueenAttackSet(queenBB, allPieceBB);
-	attackSet |= GetKingAttackSet(kingBB);
+	Bitboard enemyDiagonalsBB = context.m_enemyBishopBB | context.m_enemyQueenBB;
+	if ((m_magicBitboardHelper.GetDiagonalAttacks(square, GetDiagonalOccupancyMask(square) & occupancy) & enemyDiagonalsBB).Any())
+		return true;
 
-	return attackSet;
+	Bitboard enemyOrthogonalsBB = context.m_enemyRookBB | context.m_enemyQueenBB;
+	return (m_magicBitboardHelper.GetOrthogonalAttacks(square, GetOrthogonalOccupancyMask(square) & occupancy) & enemyOrthogonalsBB).Any();
 }
 
-Bitboard MoveGenerator::GetWhitePawnAttackSet(Bitboard pawns) const {
-	Bitboard attackSet = 0ULL;
-
-	attackSet |= pawns.ShiftNorthWest();
-	attackSet |= pawns.ShiftNorthEast();
+template<Colour Us>
+bool MoveGenerator::IsAnyAttackedByEnemy(const MoveGenerationContext& context, Bitboard squares) const {
+	for (Square square : squares) {
+		if (IsAttackedByEnemy<Us>(context, square, context.m_allPieceBB))
+			return true;
+	}
 
-	return attackSet;
+	return false;
 }
 
-Bitboard MoveGenerator::GetBlackPawnAttackSet(Bitboard pawns) const {
-	Bitboard attackSet = 0ULL;
-
-	if (pawns.Empty()) return attackSet;
-
-	attackSet |= pawns.ShiftSouthWest();
-	attackSet |= pawns.ShiftSouthEast();
-
-	return attackSet;
+Bitboard MoveGenerator::GetAttackersTo(Square square, Bitboard occupancy) const {
+	Bitboard diagonalSliders = m_board.GetPieceBitboard(Piece::WHITE_BISHOP) | m_board.GetPieceBitboard(Piece::BLACK_BISHOP) | m_board.GetPieceBitboard(Piece::WHITE_QUEEN) | m_board.GetPieceBitboard(Piece::BLACK_QUEEN);
+	Bitboard orthogonalSliders = m_board.GetPieceBitboard(Piece::WHITE_ROOK) | m_board.GetPieceBitboard(Piece::BLACK_ROOK) | m_board.GetPieceBitboard(Piece::WHITE_QUEEN) | m_board.GetPieceBitboard(Piece::BLACK_QUEEN);
+	Bitboard knights = m_board.GetPieceBitboard(Piece::WHITE_KNIGHT) | m_board.GetPieceBitboard(Piece::BLACK_KNIGHT);
+	Bitboard kings = m_board.GetPieceBitboard(Piece::WHITE_KING) | m_board.GetPieceBitboard(Piece::BLACK_KING);
+
+	// A white pawn attacks this square from wherever a black pawn on it would attack, and vice versa.
+	Bitboard attackers =
+		(m_magicBitboardHelper.GetBlackPawnAttacks(square) & m_board.GetPieceBitboard(Piece::WHITE_PAWN)) |
+		(m_magicBitboardHelper.GetWhitePawnAttacks(square) & m_board.GetPieceBitboard(Piece::BLACK_PAWN)) |
+		(m_magicBitboardHelper.GetKnightAttacks(square) & knights) |
+		(m_magicBitboardHelper.GetKingAttacks(square) & kings) |
+		(m_magicBitboardHelper.GetDiagonalAttacks(square, GetDiagonalOccupancyMask(square) & occupancy) & diagonalSliders) |
+		(m_magicBitboardHelper.GetOrthogonalAttacks(square, GetOrthogonalOccupancyMask(square) & occupancy) & orthogonalSliders);
+
+	return attackers & occupancy;
 }
 
-Bitboard MoveGenerator::GetKnightAttackSet(Bitboard knights) const {
-	Bitboard attackSet = 0ULL;
+int MoveGenerator::StaticExchangeEvaluation(const Move& move) const {
+	Square from = move.GetFrom();
+	Square to = move.GetTo();
+
+	bool isWhiteTurn = m_board.IsWhiteTurn();
 
-	if (knights.Empty()) return attackSet;
+	Bitboard occupancy = m_board.GetAllPieceBitboard() & ~Bitboard{from};
 
-	for (Square knight : knights) {
-		attackSet |= m_magicBitboardHelper.GetKnightAttacks(knight);
+	int capturedValue = 0;
+	if (move.IsEnPassant()) {
+		capturedValue = ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN];
+		occupancy &= isWhiteTurn ? ~Bitboard{to}.ShiftSouth() : ~Bitboard{to}.ShiftNorth();
+	} else if (move.IsCapture()) {
+		capturedValue = ABSOLUTE_PIECE_VALUES[m_board.GetPieceAtSquare(to)];
 	}
 
-	return attackSet;
-}
+	// The value of whatever is standing on the to square, waiting to be captured next.
+	int onSquareValue = ABSOLUTE_PIECE_VALUES[m_board.GetPieceAtSquare(from)];
 
-Bitboard MoveGenerator::GetBishopAttackSet(Bitboard bishops, Bitboard allPieces) const {
-	Bitboard attackSet{0ULL};
+	std::array<int, 32> gain;
+	gain[0] = capturedValue;
 
-	for (Square bishop : bishops) {
-		Bitboard occupancyMask = GetDiagonalOccupancyMask(bishop);
+	if (move.IsPromotion()) {
+		int promotionValue = ABSOLUTE_PIECE_VALUES[move.GetPromotionPiece(true)];
+		gain[0] += promotionValue - ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN];
+		onSquareValue = promotionValue;
+	}
 
-		Bitboard occupancy = occupancyMask & allPieces;
+	Bitboard attackers = GetAttackersTo(to, occupancy);
 
-		attackSet |= m_magicBitboardHelper.GetDiagonalAttacks(bishop, occupancy);
-	}
+	Bitboard diagonalSliders = m_board.GetPieceBitboard(Piece::WHITE_BISHOP) | m_board.GetPieceBitboard(Piece::BLACK_BISHOP) | m_board.GetPieceBitboard(Piece::WHITE_QUEEN) | m_board.GetPieceBitboard(Piece::BLACK_QUEEN);
+	Bitboard orthogonalSliders = m_board.GetPieceBitboard(Piece::WHITE_ROOK) | m_board.GetPieceBitboard(Piece::BLACK_ROOK) | m_board.GetPieceBitboard(Piece::WHITE_QUEEN) | m_board.GetPieceBitboard(Piece::BLACK_QUEEN);
 
-	return attackSet;
-}
+	bool isWhiteCapturing = !isWhiteTurn;
+	size_t depth = 0;
 
-Bitboard MoveGenerator::GetRookAttackSet(Bitboard rooks, Bitboard allPieces) const {
-	Bitboard attackSet{0ULL};
+	while (true) {
+		// Find the cheapest piece the side to capture can recapture with.
+		Piece firstPiece = isWhiteCapturing ? Piece::WHITE_PAWN : Piece::BLACK_PAWN;
+		Piece lastPiece = isWhiteCapturing ? Piece::WHITE_KING : Piece::BLACK_KING;
 
-	for (Square rook : rooks) {
-		Bitboard occupancyMask = GetOrthogonalOccupancyMask(rook);
-		Bitboard occupancy = occupancyMask & allPieces;
+		Bitboard leastValuableAttacker{0ULL};
+		Piece leastValuablePiece = Piece::EMPTY;
+		for (uint8_t p = firstPiece; p <= lastPiece; ++p) {
+			Bitboard candidates = attackers & m_board.GetPieceBitboard(static_cast<Piece>(p));
+			if (candidates.Any()) {
+				leastValuableAttacker = Bitboard{static_cast<Square>(candidates)};
+				leastValuablePiece = static_cast<Piece>(p);
+				break;
+			}
+		}
 
-		Bitboard attacks = m_magicBitboardHelper.GetOrthogonalAttacks(rook, occupancy);
+		if (leastValuablePiece == Piece::EMPTY)
+			break;
 
-		attackSet |= attacks;
-	}
+		++depth;
+		gain[depth] = onSquareValue - gain[depth - 1];
 
-	return attackSet;
-}
+		// A king can't recapture into an attacked square.
+		if ((leastValuablePiece == Piece::WHITE_KING) || (leastValuablePiece == Piece::BLACK_KING)) {
+			Bitboard enemyPieces = isWhiteCapturing ? m_board.GetBlackPieceBitboard() : m_board.GetWhitePieceBitboard();
 
-Bitboard MoveGenerator::GetQueenAttackSet(Bitboard queens, Bitboard allPieces) const {
-	Bitboard attackSet = 0ULL;
-	
-	if (queens.Empty()) return attackSet;
+			if ((attackers & enemyPieces & ~leastValuableAttacker).Any()) {
+				--depth;
+				break;
+			}
+		}
 
-	for (Square queen : queens) {
-		Bitboard orthogonalOccupancyMask = GetOrthogonalOccupancyMask(queen);
-		Bitboard orthogonalOccupancy = orthogonalOccupancyMask & allPieces;
+		occupancy &= ~leastValuableAttacker;
+		onSquareValue = ABSOLUTE_PIECE_VALUES[leastValuablePiece];
 
-		attackSet |= m_magicBitboardHelper.GetOrthogonalAttacks(queen, orthogonalOccupancy);
+		// Moving a piece off the line may uncover a slider behind it.
+		attackers |= m_magicBitboardHelper.GetDiagonalAttacks(to, GetDiagonalOccupancyMask(to) & occupancy) & diagonalSliders;
+		attackers |= m_magicBitboardHelper.GetOrthogonalAttacks(to, GetOrthogonalOccupancyMask(to) & occupancy) & orthogonalSliders;
+		attackers &= occupancy;
 
-		Bitboard diagonalOccupancyMask = GetDiagonalOccupancyMask(queen);
-		Bitboard diagonalOccupancy = diagonalOccupancyMask & allPieces;
+		isWhiteCapturing = !isWhiteCapturing;
 
-		attackSet |= m_magicBitboardHelper.GetDiagonalAttacks(queen, diagonalOccupancy);
+		if (depth == gain.size() - 1)
+			break;
 	}
 
-	return attackSet;
-}
-
-Bitboard MoveGenerator::GetKingAttackSet(Bitboard king) const {
-	Bitboard attackSet = m_magicBitboardHelper.GetKingAttacks(static_cast<Square>(king));
+	while (depth > 0) {
+		gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+		--depth;
+	}
 
-	return attackSet;
+	return gain[0];
 }
@@ -0,0 +1,140 @@
+#include "Engine/MovePicker.h"
+
+
+MovePicker::MovePicker(const MoveGenerator& moveGenerator, MoveGenerationContext& context, const Move& ttMove, const Move& firstKiller, const Move& secondKiller, const MoveHistory& moveHistory, bool isWhiteTurn) :
+	m_moveGenerator{moveGenerator},
+	m_context{context},
+	m_ttMove{ttMove},
+	m_firstKiller{firstKiller},
+	m_secondKiller{secondKiller},
+	m_moveHistory{moveHistory},
+	m_isWhiteTurn{isWhiteTurn},
+	m_stage{MovePickerStage::TT_MOVE},
+	m_moves{},
+	m_index{0},
+	m_badCaptures{},
+	m_badCaptureIndex{0}
+{}
+
+bool MovePicker::Next(Move& move) {
+	switch (m_stage) {
+		case MovePickerStage::TT_MOVE: {
+			m_stage = MovePickerStage::GENERATE_CAPTURES;
+
+			// The TT move may be from a different position that shares our key check, so it has to be checked before we play it.
+			if (m_moveGenerator.IsPseudoLegal(m_ttMove, m_context) && m_moveGenerator.IsLegal(m_ttMove, m_context)) {
+				move = m_ttMove;
+				return true;
+			}
+
+			m_ttMove = Move{};
+			[[fallthrough]];
+		}
+		case MovePickerStage::GENERATE_CAPTURES: {
+			MoveGenerationParameters params{ m_moves, MoveGenerationType::CAPTURES };
+			m_moveGenerator.GenerateMoves(params, m_context);
+
+			for (size_t i = 0; i < m_moves.size(); ++i)
+				m_scores[i] = m_moves.GetScore(i);
+
+			m_index = 0;
+			m_stage = MovePickerStage::GOOD_CAPTURES;
+			[[fallthrough]];
+		}
+		case MovePickerStage::GOOD_CAPTURES: {
+			while (PickBest(move)) {
+				if (m_moveGenerator.StaticExchangeEvaluation(move) >= 0)
+					return true;
+
+				m_badCaptures.push_back(move, m_scores[m_index - 1]);
+			}
+
+			m_stage = MovePickerStage::FIRST_KILLER;
+			[[fallthrough]];
+		}
+		case MovePickerStage::FIRST_KILLER: {
+			m_stage = MovePickerStage::SECOND_KILLER;
+
+			if (IsUsableKiller(m_firstKiller)) {
+				move = m_firstKiller;
+				return true;
+			}
+
+			m_firstKiller = Move{};
+			[[fallthrough]];
+		}
+		case MovePickerStage::SECOND_KILLER: {
+			m_stage = MovePickerStage::GENERATE_QUIETS;
+
+			if ((m_secondKiller != m_firstKiller) && IsUsableKiller(m_secondKiller)) {
+				move = m_secondKiller;
+				return true;
+			}
+
+			m_secondKiller = Move{};
+			[[fallthrough]];
+		}
+		case MovePickerStage::GENERATE_QUIETS: {
+			MoveGenerationParameters params{ m_moves, MoveGenerationType::QUIETS };
+			m_moveGenerator.GenerateMoves(params, m_context);
+
+			for (size_t i = 0; i < m_moves.size(); ++i)
+				m_scores[i] = m_moveHistory.Get(m_isWhiteTurn, m_moves[i]);
+
+			m_index = 0;
+			m_stage = MovePickerStage::QUIETS;
+			[[fallthrough]];
+		}
+		case MovePickerStage::QUIETS: {
+			if (PickBest(move))
+				return true;
+
+			m_stage = MovePickerStage::BAD_CAPTURES;
+			[[fallthrough]];
+		}
+		case MovePickerStage::BAD_CAPTURES: {
+			// These were put aside in MVV-LVA order already.
+			if (m_badCaptureIndex < m_badCaptures.size()) {
+				move = m_badCaptures[m_badCaptureIndex++];
+				return true;
+			}
+
+			m_stage = MovePickerStage::DONE;
+			[[fallthrough]];
+		}
+		case MovePickerStage::DONE:
+		default:
+			return false;
+	}
+}
+
+bool MovePicker::PickBest(Move& move) {
+	while (m_index < m_moves.size()) {
+		size_t best = m_index;
+		for (size_t j = m_index + 1; j < m_moves.size(); ++j) {
+			if (m_scores[j] > m_scores[best])
+				best = j;
+		}
+
+		std::swap(m_moves[m_index], m_moves[best]);
+		std::swap(m_scores[m_index], m_scores[best]);
+
+		move = m_moves[m_index++];
+
+		// Already tried before anything was generated.
+		if ((move == m_ttMove) || (move == m_firstKiller) || (move == m_secondKiller))
+			continue;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool MovePicker::IsUsableKiller(const Move& killer) const {
+	// Killers are only ever quiet, but the TT move may well be one of them.
+	if (killer.IsCapture() || (killer == m_ttMove))
+		return false;
+
+	return m_moveGenerator.IsPseudoLegal(killer, m_context) && m_moveGenerator.IsLegal(killer, m_context);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "Engine/Nnue.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+namespace {
+
+// Adds (or subtracts) one row of input weights to a side's half of the accumulator.
+template<bool IsAdd>
+inline void UpdateAccumulator(int16_t* values, const int16_t* weights) {
+#if defined(__AVX2__)
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+		__m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		v = IsAdd ? _mm256_add_epi16(v, w) : _mm256_sub_epi16(v, w);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(values + i), v);
+	}
+#elif defined(__SSE2__)
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 8) {
+		__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		v = IsAdd ? _mm_add_epi16(v, w) : _mm_sub_epi16(v, w);
+		_mm_store_si128(reinterpret_cast<__m128i*>(values + i), v);
+	}
+#else
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; ++i)
+		values[i] = IsAdd ? values[i] + weights[i] : values[i] - weights[i];
+#endif
+}
+
+// The sum over one side's hidden layer of clamp(value, 0, QA) * weight.
+inline int32_t ClippedReluDot(const int16_t* values, const int16_t* weights) {
+#if defined(__AVX2__)
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i qa = _mm256_set1_epi16(NNUE_QA);
+	__m256i sum = _mm256_setzero_si256();
+
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+		__m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+		__m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+		v = _mm256_min_epi16(_mm256_max_epi16(v, zero), qa);
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, w));
+	}
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+#elif defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i qa = _mm_set1_epi16(NNUE_QA);
+	__m128i sum = _mm_setzero_si128();
+
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; i += 8) {
+		__m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+		__m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+		v = _mm_min_epi16(_mm_max_epi16(v, zero), qa);
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(v, w));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#else
+	int32_t sum = 0;
+	for (size_t i = 0; i < NNUE_HIDDEN_SIZE; ++i)
+		sum += std::clamp<int32_t>(values[i], 0, NNUE_QA) * weights[i];
+	return sum;
+#endif
+}
+
+}
+
+NnueNetwork::NnueNetwork() :
+	m_inputWeights{},
+	m_inputBiases{},
+	m_outputWeights{},
+	m_outputBias{0},
+	m_isLoaded{false}
+{}
+
+bool NnueNetwork::Load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		std::cerr << "Log: Could not open network file {" << path << "}\n";
+		return false;
+	}
+
+	return Load(file, path);
+}
+
+bool NnueNetwork::Load(std::istream& stream, const std::string& name) {
+	std::vector<int16_t> inputWeights(NNUE_INPUT_SIZE * NNUE_HIDDEN_SIZE);
+	std::array<int16_t, NNUE_HIDDEN_SIZE> inputBiases;
+	std::array<int16_t, 2 * NNUE_HIDDEN_SIZE> outputWeights;
+	int16_t outputBias;
+
+	stream.read(reinterpret_cast<char*>(inputWeights.data()), inputWeights.size() * sizeof(int16_t));
+	stream.read(reinterpret_cast<char*>(inputBiases.data()), inputBiases.size() * sizeof(int16_t));
+	stream.read(reinterpret_cast<char*>(outputWeights.data()), outputWeights.size() * sizeof(int16_t));
+	stream.read(reinterpret_cast<char*>(&outputBias), sizeof(int16_t));
+
+	if (!stream) {
+		std::cerr << "Log: Network file {" << name << "} is too short\n";
+		return false;
+	}
+
+	// Anything left over means the file was made for a different architecture.
+	if (stream.peek() != std::istream::traits_type::eof()) {
+		std::cerr << "Log: Network file {" << name << "} is too long\n";
+		return false;
+	}
+
+	m_inputWeights = std::move(inputWeights);
+	m_inputBiases = inputBiases;
+	m_outputWeights = outputWeights;
+	m_outputBias = outputBias;
+	m_isLoaded = true;
+
+	std::cerr << "Log: Loaded network {" << name << "}\n";
+	return true;
+}
+
+void NnueNetwork::ResetAccumulator(NnueAccumulator& accumulator) const {
+	accumulator.m_values[0] = m_inputBiases;
+	accumulator.m_values[1] = m_inputBiases;
+}
+
+void NnueNetwork::AddPiece(NnueAccumulator& accumulator, Piece piece, Square square) const {
+	UpdateAccumulator<true>(accumulator.m_values[0].data(), &m_inputWeights[GetWhiteFeature(piece, square) * NNUE_HIDDEN_SIZE]);
+	UpdateAccumulator<true>(accumulator.m_values[1].data(), &m_inputWeights[GetBlackFeature(piece, square) * NNUE_HIDDEN_SIZE]);
+}
+
+void NnueNetwork::RemovePiece(NnueAccumulator& accumulator, Piece piece, Square square) const {
+	UpdateAccumulator<false>(accumulator.m_values[0].data(), &m_inputWeights[GetWhiteFeature(piece, square) * NNUE_HIDDEN_SIZE]);
+	UpdateAccumulator<false>(accumulator.m_values[1].data(), &m_inputWeights[GetBlackFeature(piece, square) * NNUE_HIDDEN_SIZE]);
+}
+
+int NnueNetwork::Evaluate(const NnueAccumulator& accumulator, bool isWhiteTurn) const {
+	const std::array<int16_t, NNUE_HIDDEN_SIZE>& us = accumulator.m_values[isWhiteTurn ? 0 : 1];
+	const std::array<int16_t, NNUE_HIDDEN_SIZE>& them = accumulator.m_values[isWhiteTurn ? 1 : 0];
+
+	int32_t output = ClippedReluDot(us.data(), m_outputWeights.data()) + ClippedReluDot(them.data(), m_outputWeights.data() + NNUE_HIDDEN_SIZE);
+
+	return (output + m_outputBias) * NNUE_SCALE / (NNUE_QA * NNUE_QB);
+}
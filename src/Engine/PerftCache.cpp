@@ -0,0 +1,35 @@
+#include "Engine/PerftCache.h"
+
+
+PerftCache::PerftCache(size_t sizeMb) :
+	m_numBuckets{ (sizeMb * 1024 * 1024) / sizeof(PerftCacheBucket) },
+	m_table{ std::make_unique<PerftCacheBucket[]>(m_numBuckets) }
+{}
+
+bool PerftCache::Get(Hash key, int8_t depth, uint64_t& count) const {
+	const PerftCacheBucket& bucket = GetBucket(key);
+	return Get(bucket.m_deepest, key, depth, count) || Get(bucket.m_latest, key, depth, count);
+}
+
+void PerftCache::Set(Hash key, int8_t depth, uint64_t count) {
+	PerftCacheBucket& bucket = GetBucket(key);
+
+	uint64_t data = (count << PERFT_CACHE_DEPTH_BITS) | static_cast<uint8_t>(depth);
+
+	uint64_t deepestDepth = bucket.m_deepest.m_data.load(std::memory_order_relaxed) & PERFT_CACHE_DEPTH_MASK;
+	PerftCacheEntry& entry = (static_cast<uint64_t>(depth) >= deepestDepth) ? bucket.m_deepest : bucket.m_latest;
+
+	entry.m_keyXorData.store(key ^ data, std::memory_order_relaxed);
+	entry.m_data.store(data, std::memory_order_relaxed);
+}
+
+bool PerftCache::Get(const PerftCacheEntry& entry, Hash key, int8_t depth, uint64_t& count) {
+	uint64_t data = entry.m_data.load(std::memory_order_relaxed);
+	uint64_t keyXorData = entry.m_keyXorData.load(std::memory_order_relaxed);
+
+	if ((keyXorData ^ data) != key || (data & PERFT_CACHE_DEPTH_MASK) != static_cast<uint8_t>(depth))
+		return false;
+
+	count = data >> PERFT_CACHE_DEPTH_BITS;
+	return true;
+}
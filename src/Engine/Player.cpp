@@ -5,28 +5,70 @@ Player::Player(Board& board) :
 	m_board{board},
 	m_moveGenerator{m_board},
 	m_transpositionTable{},
-	m_killers{},
-#if DEBUG
-	m_principleVariation{},
-#endif
-	m_nodesSearched{0},
+	m_network{},
+	m_networkFile{DEFAULT_NNUE_FILE},
+	m_useNetwork{false},
+	m_searchers{},
 	m_deadline{},
-	m_isStopped{false}
+	m_isStopped{false},
+	m_isPondering{false},
+	m_timeAllowed{},
+	m_ponderMutex{}
 {
-	InitialisePieceSquareTables();
+	SetThreads(DEFAULT_THREADS);
+}
+
+void Player::SetThreads(size_t numThreads) {
+	if (numThreads < 1)
+		numThreads = 1;
+
+	m_searchers.resize(std::min(numThreads, m_searchers.size()));
+
+	while (m_searchers.size() < numThreads)
+		m_searchers.push_back(std::make_unique<Searcher>(m_searchers.size(), m_transpositionTable, m_deadline, m_isStopped));
+
+	std::cerr << "Log: Searching with " << m_searchers.size() << " thread(s).\n";
+}
+
+bool Player::SetNetworkFile(const std::string& path) {
+	if (path == m_networkFile)
+		return true;
+
+	m_networkFile = path;
+
+	if (!m_useNetwork) {
+		// Drop the old network so that the new file is the one loaded when the network is turned on.
+		m_network = NnueNetwork{};
+		return true;
+	}
+
+	if (!m_network.Load(m_networkFile)) {
+		std::cout << "Error: Could not load network {" << m_networkFile << "}, evaluating with PSTs.\n";
+		SetUseNetwork(false);
+		return false;
+	}
+
+	m_board.RebuildAccumulator();
+	return true;
 }
 
-void Player::InitialisePieceSquareTables() {
-	#define X(piece) 																																									\
-	for (size_t i = static_cast<size_t>(Square::h1); i < static_cast<size_t>(Square::COUNT); ++i) {																						\
-		m_midgamePieceSquareTables[static_cast<size_t>(Piece::piece)][i] = MG_PIECE_VALUES[static_cast<size_t>(Piece::piece)] - MG_PST_LIST[static_cast<size_t>(Piece::piece)][i]; 		\
-		m_endgamePieceSquareTables[static_cast<size_t>(Piece::piece)][i] = EG_PIECE_VALUES[static_cast<size_t>(Piece::piece)] - EG_PST_LIST[static_cast<size_t>(Piece::piece)][i];		\
+bool Player::SetUseNetwork(bool useNetwork) {
+	bool isAvailable = !useNetwork || m_network.IsLoaded() || m_network.Load(m_networkFile);
+	if (!isAvailable) {
+		std::cout << "Error: Could not load network {" << m_networkFile << "}, evaluating with PSTs.\n";
+		useNetwork = false;
+	}
+
+	if (useNetwork != m_useNetwork) {
+		m_useNetwork = useNetwork;
+		m_board.SetNetwork(m_useNetwork ? &m_network : nullptr);
 	}
-	PIECES_LIST
-	#undef X
+
+	std::cerr << "Log: Evaluating with " << (m_useNetwork ? "NNUE" : "PSTs") << ".\n";
+	return isAvailable;
 }
 
-Move Player::Go(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime) {
+Move Player::Go(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime, bool infinite) {
 	Moment startTime = Clock::now();
 
 	if (depth <= 0)
@@ -34,7 +76,9 @@ Move Player::Go(int depth, int wtime, int btime, int winc, int binc, int movesto
 
 	float timeAllowedSecs;
 
-	if (movetime > 0) {
+	if (infinite) {
+		timeAllowedSecs = 0;
+	} else if (movetime > 0) {
 		timeAllowedSecs = movetime / 1000.0f;
 	} else if (m_board.IsWhiteTurn() && wtime > 0) {
 		float whiteTimeSecs = wtime / 1000.0f;
@@ -54,622 +98,213 @@ Move Player::Go(int depth, int wtime, int btime, int winc, int binc, int movesto
 	if (timeAllowedSecs > 0.1)
 		timeAllowedSecs -= 0.1;
 
-	std::cerr << "Log: Spending " << timeAllowedSecs << "s on this move.\n\n";
-
-	m_deadline = startTime + ms(SecsToMillisecs(timeAllowedSecs));
-	Move bestMove = IterativeDeepening(depth);
-
-#if DEBUG
-	auto searchTime = Clock::now() - startTime;
-	auto searchTimeS = std::chrono::duration_cast<ms>(searchTime).count() / 1000.0;
-	std::cerr << "Log: Nodes searched: " << m_nodesSearched << '\n';
-	std::cerr << "Log: Search speed (nps): " << m_nodesSearched / searchTimeS << '\n';
-	std::cerr << "Log: Search time (s): " << searchTimeS << "\n\n";
-#endif
-
-	return bestMove;
-}
-
-int16_t Player::Evaluate() {
-	int eval = 0;
+	{
+		// A ponderhit may race with us setting up the deadline, so both happen under the same lock.
+		std::lock_guard<std::mutex> lock(m_ponderMutex);
 
-	int mg_eval = 0;
-	int eg_eval = 0;
+		m_timeAllowed = ms(SecsToMillisecs(timeAllowedSecs));
 
-	#define X(piece) 																									\
-	for (Square piecePosition : m_board.GetPieceBitboard(Piece::piece)) { 												\
-		mg_eval += m_midgamePieceSquareTables[static_cast<size_t>(Piece::piece)][static_cast<size_t>(piecePosition)];	\
-		eg_eval += m_endgamePieceSquareTables[static_cast<size_t>(Piece::piece)][static_cast<size_t>(piecePosition)];	\
+		if (infinite || m_isPondering) {
+			std::cerr << "Log: Searching until told to stop.\n\n";
+			m_deadline = Moment::max();
+		} else {
+			std::cerr << "Log: Spending " << timeAllowedSecs << "s on this move.\n\n";
+			m_deadline = startTime + m_timeAllowed;
+		}
 	}
-	PIECES_LIST
-	#undef X
-
-	Square whiteKingSquare = static_cast<Square>(m_board.GetPieceBitboard(Piece::WHITE_KING));
-	Bitboard whiteKingDefenders = m_board.GetPieceBitboard(Piece::WHITE_PAWN) & WHITE_KING_DEFENDERS_MASK & WHITE_KING_DEFENCE_MASKS[static_cast<size_t>(whiteKingSquare)];
-
-	for (Square sq : whiteKingDefenders)
-		mg_eval += KING_DEFENCE_PAWN_PST[static_cast<size_t>(sq)];
-
-	Square blackKingSquare = static_cast<Square>(m_board.GetPieceBitboard(Piece::BLACK_KING));
-	Bitboard blackKingDefenders = m_board.GetPieceBitboard(Piece::BLACK_PAWN) & BLACK_KING_DEFENDERS_MASK & BLACK_KING_DEFENCE_MASKS[static_cast<size_t>(blackKingSquare)];
-
-	for (Square sq : blackKingDefenders)
-		mg_eval -= KING_DEFENCE_PAWN_PST[static_cast<size_t>(sq)];
-
-	int phase = m_board.GetPhase();
-
-	eval += mg_eval * phase;
-	eval += eg_eval * (START_PHASE - phase);
-
-	eval /= START_PHASE;
 
-	if (!m_board.IsWhiteTurn())
-		eval *= -1;
+	m_transpositionTable.Allocate();
+	m_transpositionTable.NewSearch();
 
-	return static_cast<int16_t>(eval);
-}
+	for (std::unique_ptr<Searcher>& searcher : m_searchers)
+		searcher->SetPosition(m_board);
 
-Move Player::IterativeDeepening(int8_t maxDepth) {
-	m_nodesSearched = 0;
-	m_isStopped = false;
+	std::vector<std::thread> helperThreads;
+	for (size_t i = 1; i < m_searchers.size(); ++i)
+		helperThreads.emplace_back([this, i, depth]() { m_searchers[i]->IterativeDeepening(depth); });
 
-	m_killers.Reset();
+	Move bestMove = m_searchers.front()->IterativeDeepening(depth);
 
-	// Hack: Check if there is a chance we will threefold repeat. If so, clear TT table to make sure we don't use old value and repeat when winning.
-	if (m_board.IsRepeatPosition())
-		m_transpositionTable.Clear();
+	// An infinite or pondering search must not report a move until it is stopped (or the ponder is hit),
+	// even if it has run out of depth or found a mate.
+	while ((infinite || m_isPondering) && !m_isStopped)
+		std::this_thread::sleep_for(ms(1));
 
-	int8_t depth = 1;
-	Move pvMove;
-	int16_t bestScore = RootNegamax(depth, -MAX_SCORE, MAX_SCORE, GARBAGE_MOVE, pvMove);
-	++depth;
+	// Only the main thread's result is used, so once it is done the helpers can be called off.
+	m_isStopped = true;
+	for (std::thread& helperThread : helperThreads)
+		helperThread.join();
 
-	while (depth <= maxDepth) {
 #if DEBUG
-		m_currentDepthNodes = 0;
-		m_quiescenceNodesSearched = 0;
-#endif
-
-		int16_t delta = ASPIRATION_WINDOW_DELTA;
-		int16_t alpha = bestScore - delta;
-		int16_t beta = bestScore + delta;
-		int16_t score;
-		Move bestMove;
-
-		while (true) {
-			score = RootNegamax(depth, alpha, beta, pvMove, bestMove);
-
-			if (m_isStopped)
-				break;
-
-			if (score <= alpha) {
-				if (score < -MATE_THRESHOLD) {
-					alpha = -MAX_SCORE;
-				} else {
-					alpha -= delta;
-					delta *= 2;
-				}
-			} else if (score >= beta) {
-				if (score > MATE_THRESHOLD) {
-					beta = MAX_SCORE;
-				} else {
-					beta += delta;
-					delta *= 2;
-				}
-			} else {
-				break;
-			}
-		}
-
-		if (m_isStopped)
-			break;
-
-		pvMove = bestMove;
-		bestScore = score;
-
-		if ((bestScore > MATE_THRESHOLD) || (bestScore < -MATE_THRESHOLD))
-			break;
-		
-		++depth;
+	uint64_t nodesSearched = GetNodesSearched();
 
-#if DEBUG
-		std::cerr << "Log: Current depth nodes: " << m_currentDepthNodes << '\n';
-		std::cerr << "Log: Current depth quiescence nodes searched: " << m_quiescenceNodesSearched << '\n';
-		std::cerr << "Log: Transpositions hit: " << m_transpositionsHit << '\n';
-		float ebf = pow(m_currentDepthNodes, (1.0f / depth));
-		std::cerr << "Log: EBF: " << ebf << "\n";
-		std::cerr << m_principleVariation;
+	auto searchTime = Clock::now() - startTime;
+	auto searchTimeS = std::chrono::duration_cast<ms>(searchTime).count() / 1000.0;
+	std::cerr << "Log: Nodes searched: " << nodesSearched << '\n';
+	std::cerr << "Log: Search speed (nps): " << nodesSearched / searchTimeS << '\n';
+	std::cerr << "Log: Search time (s): " << searchTimeS << "\n\n";
 #endif
-	}
 
-	return pvMove;
+	return bestMove;
 }
 
-int16_t Player::RootNegamax(int8_t depth, int16_t alpha, int16_t beta, const Move& prevBestMove, Move& bestMove) {
-#if DEBUG
-	++m_currentDepthNodes;
-	m_transpositionsHit = 0;
-	m_principleVariation.Reset();
-	std::cerr << "Log: Called root Negamax with depth " << (int) depth << '\n';
-#endif
-
-	++m_nodesSearched;
-
-	if (m_board.CheckQuietDraws())
-		return DRAW_SCORE;
-
-	MoveList moves;
-	MoveGenerationParameters params { moves, false };
-	bool check = m_moveGenerator.GenerateMoves(params);
-
-	if (moves.size() == 0)
-		return check ? (-MATE_SCORE + m_board.GetMoveCount()) : DRAW_SCORE;
-
-	int8_t ply = 0;
-
-	std::array<int, MoveList::MAX_POSSIBLE_MOVES> staticScores;
-	for (int i = 0; i < moves.size(); ++i) {
-		const Move& move = moves[i];
-		if (move == prevBestMove) {
-			staticScores[i] = PV_MOVE_BASE_SCORE;
-		} else if (!move.m_isCapture && move == m_killers.GetFirst(depth))
-			staticScores[i] = FIRST_KILLER_BASE_SCORE;
-		else if (!move.m_isCapture && move == m_killers.GetSecond(depth))
-			staticScores[i] = SECOND_KILLER_BASE_SCORE;
-		else if (move.m_isCapture)
-			staticScores[i] = move.m_score;
-		else
-			staticScores[i] = m_moveHistory.Get(m_board.IsWhiteTurn(), move);
-	}
-
-	int16_t bestScore = -MAX_SCORE;
-
-	for (int i = 0; i < moves.size(); ++i) {
-
-		int best = i;
-		for (int j = i + 1; j < moves.size(); ++j) {
-			if (staticScores[j] > staticScores[best])
-				best = j;
-		}
-
-		std::swap(moves[i], moves[best]);
-		std::swap(staticScores[i], staticScores[best]);
-
-		const Move& move = moves[i];
-		Undo undo = m_board.MakeMove(move);
-
-		int16_t score;
-		if (i == 0) {
-			score = -Negamax(depth-1, ply+1, -beta, -alpha);
-		} else {
-			score = -Negamax(depth-1, ply+1, -(alpha+1), -alpha);
-			if (score > alpha && score < beta)
-				score = -Negamax(depth-1, ply+1, -beta, -alpha);
-		}
-
-		m_board.UndoMove(move, undo);
-
-		if (m_isStopped)
-			return NO_SCORE;
+void Player::NewGame() {
+	m_transpositionTable.Clear();
 
-		if (score > bestScore) {
-			bestScore = score;
-			bestMove = move;
+	for (std::unique_ptr<Searcher>& searcher : m_searchers)
+		searcher->Clear();
+}
 
-			if (score > alpha) {
-				alpha = score;
-#if DEBUG
-				m_principleVariation.Set(ply, bestMove);
-#endif
-				if (score > beta) {
-					if (!move.m_isCapture) {
-						m_killers.Set(depth, move);
+uint64_t Player::GetNodesSearched() const noexcept {
+	uint64_t nodesSearched = 0;
+	for (const std::unique_ptr<Searcher>& searcher : m_searchers)
+		nodesSearched += searcher->GetNodesSearched();
 
-						m_moveHistory.Adjust(m_board.IsWhiteTurn(), move, depth*depth);
+	return nodesSearched;
+}
 
-						// Penalise quiet moves tried before this
-						for (int j=0; j<i; ++j) {
-							if (!moves[j].m_isCapture)
-								m_moveHistory.Adjust(m_board.IsWhiteTurn(), moves[j], -depth*depth);
-						}
-					}
+void Player::PonderHit() {
+	std::lock_guard<std::mutex> lock(m_ponderMutex);
 
-					return bestScore;
-				}
-			}
-		}
-	}
+	if (!m_isPondering)
+		return;
 
-	std::cerr << "Log: Negamax depth " << (int) depth << " returned an evaluation of " << bestScore << "\n";
-	std::cerr << "Log: Negamax " << (int) depth << " found the best move to be " << bestMove;
+	// The opponent played the expected move, so carry on with the same search but start the clock now.
+	m_isPondering = false;
+	m_deadline = Clock::now() + m_timeAllowed;
 
-	return bestScore;
+	std::cerr << "Log: Ponderhit, spending " << m_timeAllowed.count() / 1000.0 << "s on this move.\n\n";
 }
 
-int16_t Player::Negamax(int8_t depth, int8_t ply, int16_t alpha, int16_t beta, bool nmp) {
-	++m_nodesSearched;
-#if DEBUG
-	++m_currentDepthNodes;
-	m_principleVariation.Reset(ply);
-#endif
-
-	if (m_isStopped)
-		return NO_SCORE;
+bool Player::GetPonderMove(const Move& bestMove, Move& ponderMove) {
+	if (bestMove.IsNull())
+		return false;
 
-	if (((m_nodesSearched % 2048) == 0) && (Clock::now() >= m_deadline)) {
-		m_isStopped = true;
-		return NO_SCORE;
-	}
+	// The expected reply is whatever the TT thinks is best after our move. It may have been overwritten
+	// by another position, so only trust it if it is actually legal there.
+	Undo undo = m_board.MakeMove(bestMove);
 
-	if (m_board.CheckQuietDraws())
-		return DRAW_SCORE;
+	bool isFound = false;
+	TranspositionTableEntry ttEntry;
 
-	Hash hash = m_board.GetHash();
-	const TranspositionTableEntry* pEntry = m_transpositionTable.GetEntry(hash);
-	bool isTransposition = pEntry != nullptr;
+	if (m_transpositionTable.GetEntry(m_board.GetHash(), ttEntry)) {
+		MoveList moves;
+		MoveGenerationParameters params{ moves, MoveGenerationType::ALL };
+		m_moveGenerator.GenerateMoves(params);
 
-	if (isTransposition && (pEntry->m_depth >= depth)) {
-#if DEBUG
-				++m_transpositionsHit;
-#endif
-		switch (pEntry->m_evaluationType) {
-			case EvaluationType::EXACT: {
-#if DEBUG
-				m_principleVariation.Set(ply, pEntry->m_move);
-#endif
-				if (pEntry->m_score > MATE_THRESHOLD)
-					return pEntry->m_score - ply;
-				if (pEntry->m_score < -MATE_THRESHOLD)
-					return pEntry->m_score + ply;
-				return pEntry->m_score;
-			}
-			case EvaluationType::LOWER_BOUND: {
-				if (pEntry->m_score >= beta)
-					return pEntry->m_score;
-				if (pEntry->m_score > alpha) {
-					alpha = pEntry->m_score;
-				}
-				break;
-			}
-			case EvaluationType::UPPER_BOUND: {
-				if (pEntry->m_score <= alpha)
-					return pEntry->m_score;
-				beta = std::min(beta, pEntry->m_score);
+		for (const Move& move : moves) {
+			if (move == ttEntry.m_move) {
+				ponderMove = move;
+				isFound = true;
 				break;
 			}
 		}
 	}
 
-	MoveGenerationContext context = m_moveGenerator.GetMoveGenerationContext();
-
-	if (!m_moveGenerator.IsZugzwangLikely(context) && (depth > (NULL_MOVE_PRUNING_REDUCTION + 1)) && !nmp) {
-		Undo undo = m_board.MakeNullMove();
-		int16_t score = -Negamax(depth - NULL_MOVE_PRUNING_REDUCTION, ply+1, -beta, -(beta - 1), true);
-		m_board.UndoNullMove(undo);
+	m_board.UndoMove(bestMove, undo);
 
-		if (score >= beta) {
-			return score;
-		}
-	}
+	return isFound;
+}
 
-	MoveList moves;
-	MoveGenerationParameters params{ moves, false };
-	bool check = m_moveGenerator.GenerateMoves(params, context);
+int16_t Player::Evaluate() {
+	Searcher& mainSearcher = *m_searchers.front();
+	mainSearcher.SetPosition(m_board);
+	return mainSearcher.Evaluate();
+}
 
-	if (moves.size() == 0)
-		return check ? (-MATE_SCORE + ply) : DRAW_SCORE;
+uint64_t Player::RootPerft(int8_t depth, const PerftParameters& params, PerftStatistics& statistics) {
+	statistics = PerftStatistics{};
 
 	if (depth == 0)
-		return Quiescence(ply+1, alpha, beta);
-
-	std::array<int, MoveList::MAX_POSSIBLE_MOVES> staticScores;
-	for (int i = 0; i < moves.size(); ++i) {
-		const Move& move = moves[i];
-		if (isTransposition && (move == pEntry->m_move))
-			staticScores[i] = TT_MOVE_BASE_SCORE;
-		else if (!move.m_isCapture && (move == m_killers.GetFirst(depth)))
-			staticScores[i] = FIRST_KILLER_BASE_SCORE;
-		else if (!move.m_isCapture && (move == m_killers.GetSecond(depth)))
-			staticScores[i] = SECOND_KILLER_BASE_SCORE;
-		else if (move.m_isCapture)
-			staticScores[i] = move.m_score;
-		else
-			staticScores[i] = m_moveHistory.Get(m_board.IsWhiteTurn(), move);
-	}
-
-	int16_t bestScore = -MAX_SCORE;
-	Move bestMove{ GARBAGE_MOVE };
-	EvaluationType evaluationType = EvaluationType::UPPER_BOUND;
-
-	for (int i = 0; i < moves.size(); ++i) {
-
-		int best = i;
-		for (int j = i + 1; j < moves.size(); ++j) {
-			if (staticScores[j] > staticScores[best])
-				best = j;
-		}
-
-		std::swap(moves[i], moves[best]);
-		std::swap(staticScores[i], staticScores[best]);
-
-		bool isFirstMove = (i == 0);
-
-		const Move& move = moves[i];
-		Undo undo = m_board.MakeMove(move);
-
-		// LMR
-
-		int16_t score;
-		if (isFirstMove) {
-			score = -Negamax(depth-1, ply+1, -beta, -alpha);
-		} else {
-			bool shouldLmr = (depth > 4) && (i > 5);
-
-			int8_t lmrReduction = 0;
-			if (shouldLmr)
-				lmrReduction = 1;//(i < 6) ? 1 : (depth / 3);
-			
-			score = -Negamax(depth-lmrReduction-1, ply+1, -(alpha+1), -alpha);
-
-			if ((alpha < score) && (score < beta))
-				score = -Negamax(depth-1, ply+1, -beta, -alpha);
-		}
-
-		m_board.UndoMove(move, undo);
-
-		if (score > bestScore) {
-			bestScore = score;
-			bestMove = move;
-			if (bestScore > alpha) {
-				alpha = bestScore;
-				evaluationType = EvaluationType::EXACT;
-#if DEBUG
-				m_principleVariation.Set(ply, bestMove);
-#endif
-
-				if (bestScore >= beta) {
-					evaluationType = EvaluationType::LOWER_BOUND;
-
-					if (!move.m_isCapture) {
-						m_killers.Set(depth, move);
-
-						m_moveHistory.Adjust(m_board.IsWhiteTurn(), move, depth*depth);
-
-						// Penalise quiet moves tried before this
-						for (int j=0; j<i; ++j) {
-							if (!moves[j].m_isCapture)
-								m_moveHistory.Adjust(m_board.IsWhiteTurn(), moves[j], -depth*depth);
-						}
-					}
-
-					break;
-				}
-			}
-		}
-	}
-
-	TranspositionTableEntry entry {
-		bestMove,
-		hash,
-		bestScore,
-		depth,
-		evaluationType
-	};
-
-	m_transpositionTable.SetEntry(hash, entry);
-
-	return bestScore;
-}
-
-int16_t Player::Quiescence(int8_t ply, int16_t alpha, int16_t beta) {
-	++m_nodesSearched;
-#if DEBUG
-	++m_quiescenceNodesSearched;
-	++m_currentDepthNodes;
-#endif
+		return 1;
 
-	if (m_isStopped)
-		return 0;
+	MoveList moves;
+	MoveGenerationParameters moveParams{ moves, MoveGenerationType::ALL };
+	m_moveGenerator.GenerateMoves(moveParams);
 
-	if (((m_nodesSearched % 2048) == 0) && (Clock::now() >= m_deadline)) {
-		m_isStopped = true;
+	if (moves.size() == 0)
 		return 0;
-	}
-
-	int8_t depth = 0;
-
-	Hash hash = m_board.GetHash();
-	const TranspositionTableEntry* pEntry = m_transpositionTable.GetEntry(hash);
-	bool isTransposition = pEntry != nullptr;
-
-	if (isTransposition && pEntry->m_depth == 0) {
-#if DEBUG
-				++m_transpositionsHit;
-#endif
-		switch (pEntry->m_evaluationType) {
-			case EvaluationType::EXACT: {
-				// When using a TT mate score, penalise it by however far away from the position is from root
-				// because if the current position is mate in N and it has taken M plies to get here, it's a mate in N+M.
-				if (pEntry->m_score > MATE_THRESHOLD)
-					return pEntry->m_score - ply;
-				if (pEntry->m_score < -MATE_THRESHOLD)
-					return pEntry->m_score + ply;
-				return pEntry->m_score;
-			}
-			case EvaluationType::LOWER_BOUND: {
-				if (pEntry->m_score >= beta)
-					return pEntry->m_score;
-				alpha = std::max(alpha, pEntry->m_score);
-				break;
-			}
-			case EvaluationType::UPPER_BOUND: {
-				if (pEntry->m_score <= alpha)
-					return pEntry->m_score;
-				beta = std::min(beta, pEntry->m_score);
-				break;
-			}
-		}
-	}
-
-	int16_t eval = Evaluate();
 
-	if (eval >= beta) {
-		TranspositionTableEntry entry {
-			Move{ QUIET_MOVE_BASE_SCORE, Square::NONE, Square::NONE },
-			hash,
-			eval,
-			depth,
-			EvaluationType::LOWER_BOUND
-		};
+	std::unique_ptr<PerftCache> cache = (params.m_cacheSizeMb > 0) ? std::make_unique<PerftCache>(params.m_cacheSizeMb) : nullptr;
 
-		m_transpositionTable.SetEntry(hash, entry);
+	// Each thread takes the next unclaimed root move and counts it on its own copy of the board,
+	// so the threads share nothing but the move index, the cache and their own slots in the results.
+	std::vector<uint64_t> moveTotals(moves.size(), 0);
+	std::atomic<size_t> nextMove{0};
+	std::mutex statisticsMutex;
 
-		return eval;
-	}
-
-	if (eval > alpha)
-		alpha = eval;
-
-	MoveList captures;
-	MoveGenerationParameters params{ captures, true };
-	m_moveGenerator.GenerateMoves(params);
-
-	std::array<int, MoveList::MAX_POSSIBLE_MOVES> staticScores;
+	auto worker = [this, depth, &params, &moves, &moveTotals, &nextMove, &cache, &statistics, &statisticsMutex]() {
+		std::unique_ptr<Board> board = std::make_unique<Board>(m_board);
+		std::unique_ptr<MoveGenerator> moveGenerator = std::make_unique<MoveGenerator>(*board);
+		PerftStatistics threadStatistics{};
 
-	for (int i = 0; i < captures.size(); ++i) {
-		if (isTransposition && (captures[i] == pEntry->m_move)) {
-			staticScores[i] = TT_MOVE_BASE_SCORE;
-		} else {
-			staticScores[i] = captures[i].m_score;
+		for (size_t i = nextMove++; i < moves.size(); i = nextMove++) {
+			Undo undo = board->MakeMove(moves[i]);
+			moveTotals[i] = Perft(*board, *moveGenerator, depth - 1, params.m_isBulkCounting, cache.get(), threadStatistics);
+			board->UndoMove(moves[i], undo);
 		}
-	}
-
-	int16_t bestScore = eval;
-	Move bestMove{ QUIET_MOVE_BASE_SCORE, Square::NONE, Square::NONE };
-	EvaluationType evaluationType = EvaluationType::UPPER_BOUND;
 
-	for (int i = 0; i < captures.size(); ++i) {
-		int best = i;
-		for (int j = i + 1; j < captures.size(); ++j) {
-			if (staticScores[j] > staticScores[best])
-				best = j;
-		}
-
-		std::swap(captures[i], captures[best]);
-		std::swap(staticScores[i], staticScores[best]);
-
-		const Move& capture = captures[i];
-
-		int attackerValue = ABSOLUTE_PIECE_VALUES[m_board.GetPieceAtSquare(capture.m_from)];
-		int victimValue = capture.m_isEnPassant ? 100 : ABSOLUTE_PIECE_VALUES[m_board.GetPieceAtSquare(capture.m_to)];
+		std::lock_guard<std::mutex> lock(statisticsMutex);
+		statistics.m_cacheProbes += threadStatistics.m_cacheProbes;
+		statistics.m_cacheHits += threadStatistics.m_cacheHits;
+	};
 
-		if ((capture.m_promotionPiece != Piece::EMPTY) && (attackerValue < victimValue))
-			continue;
+	size_t numThreads = std::clamp<size_t>(params.m_numThreads, 1, moves.size());
 
-		if ((capture.m_promotionPiece != Piece::EMPTY) && ((eval + victimValue + DELTA_PRUNE_MARGIN) < alpha))
-			continue;
+	std::vector<std::thread> helperThreads;
+	for (size_t i = 1; i < numThreads; ++i)
+		helperThreads.emplace_back(worker);
 
-		Undo undo = m_board.MakeMove(capture);
-		int16_t score = -Quiescence(++ply, -beta, -alpha);
-		m_board.UndoMove(capture, undo);
+	worker();
 
-		if (score > bestScore) {
-			bestScore = score;
-			bestMove = capture;
-		}
+	for (std::thread& helperThread : helperThreads)
+		helperThread.join();
 
-		if (score >= beta) {
-			evaluationType = EvaluationType::UPPER_BOUND;
-			break;
-		}
-		
-		if (score > alpha) {
-			alpha = score;
-		}
+	uint64_t overallTotal = 0;
+	for (size_t i = 0; i < moves.size(); ++i) {
+		overallTotal += moveTotals[i];
+		if (params.m_isDivide)
+			std::cout << moves[i].ToString() << ": " << moveTotals[i] << '\n';
 	}
 
-	TranspositionTableEntry entry {
-		bestMove,
-		hash,
-		bestScore,
-		depth,
-		evaluationType
-	};
-
-	m_transpositionTable.SetEntry(hash, entry);
-
-	return bestScore;
+	return overallTotal;
 }
 
-int Player::RootPerft(int8_t depth) {
-#if DEBUG
-	auto startTime = std::chrono::system_clock::now();
-#endif
-
+uint64_t Player::Perft(Board& board, const MoveGenerator& moveGenerator, int8_t depth, bool isBulkCounting, PerftCache* cache, PerftStatistics& statistics) {
 	if (depth == 0)
 		return 1;
 
 	MoveList moves;
-	MoveGenerationParameters params{ moves, false };
-	m_moveGenerator.GenerateMoves(params);
-
-	if (moves.size() == 0)
-		return 0;
-	
-	int overallTotal = 0;
-	for (const Move& move : moves) {
-		Undo undo = m_board.MakeMove(move);
-		int total = Perft(depth - 1);
-		m_board.UndoMove(move, undo);
-
-		overallTotal += total;
+	MoveGenerationParameters params{ moves, MoveGenerationType::ALL };
 
-		std::cout << move.ToString() << ": " << total << '\n';
+	// The generator only produces legal moves, so the last ply needs nothing more than counting them.
+	// That is cheaper than a cache probe, so it comes first.
+	if (isBulkCounting && depth == 1) {
+		moveGenerator.GenerateMoves(params);
+		return moves.size();
 	}
 
+	if (cache) {
+		++statistics.m_cacheProbes;
 
-#if DEBUG
-	auto endTime = std::chrono::system_clock::now();
-	auto searchTime = endTime - startTime;
-	auto searchTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(searchTime).count();
-	auto searchTimeS = searchTimeMs / 1000.0;
-
-	std::cerr << "Log: Search time (s): " << searchTimeS << '\n';
-	std::cerr << "Log: Nodes per second: " << overallTotal / searchTimeS << '\n';
-#endif
-
-	return overallTotal;
-}
-
-int Player::Perft(int8_t depth) {
-	if (depth == 0)
-		return 1;
-
-	MoveList moves;
-	MoveGenerationParameters params{ moves, false };
-	m_moveGenerator.GenerateMoves(params);
+		uint64_t count;
+		if (cache->Get(board.GetHash(), depth, count)) {
+			++statistics.m_cacheHits;
+			return count;
+		}
+	}
 
-	if (moves.size() == 0)
-		return 0;
+	moveGenerator.GenerateMoves(params);
 	
-	int total = 0;
+	uint64_t total = 0;
 	for (const Move& move : moves) {
-		Undo undo = m_board.MakeMove(move);
-		total += Perft(depth - 1);
-		m_board.UndoMove(move, undo);
+		Undo undo = board.MakeMove(move);
+		total += Perft(board, moveGenerator, depth - 1, isBulkCounting, cache, statistics);
+		board.UndoMove(move, undo);
 	}
 
-	return total;
-}
+	if (cache)
+		cache->Set(board.GetHash(), depth, total);
 
-#if DEBUG
-void Player::PrintPv(int8_t depth) {
-	std::cerr << "PV: ";
-
-	for (int i=0; i < m_principleVariation.GetLength(); ++i) {
-		std::cerr << m_principleVariation.Get(i).ToString() << ", ";
-	}
-
-	std::cerr << "\n\n";
-}
-#endif
+	return total;
+}
\ No newline at end of file
@@ -0,0 +1,587 @@
+#include "Engine/Searcher.h"
+
+
+Searcher::Searcher(size_t id, TranspositionTable& transpositionTable, const std::atomic<Moment>& deadline, std::atomic<bool>& isStopped) :
+	m_id{id},
+	m_board{},
+	m_moveGenerator{m_board},
+	m_transpositionTable{transpositionTable},
+	m_killers{},
+	m_moveHistory{},
+#if DEBUG
+	m_principleVariation{},
+#endif
+	m_nodesSearched{0},
+	m_repetitionsFound{0},
+	m_deadline{deadline},
+	m_isStopped{isStopped}
+{}
+
+int16_t Searcher::Evaluate() {
+	if (const NnueNetwork* network = m_board.GetNetwork()) {
+		// Keep the network well clear of the mate scores.
+		int nnueEval = network->Evaluate(m_board.GetAccumulator(), m_board.IsWhiteTurn());
+		return static_cast<int16_t>(std::clamp(nnueEval, -MATE_THRESHOLD + 1, MATE_THRESHOLD - 1));
+	}
+
+	int eval = 0;
+
+	int mg_eval = m_board.GetMidgameScore();
+	int eg_eval = m_board.GetEndgameScore();
+
+	Square whiteKingSquare = static_cast<Square>(m_board.GetPieceBitboard(Piece::WHITE_KING));
+	Bitboard whiteKingDefenders = m_board.GetPieceBitboard(Piece::WHITE_PAWN) & WHITE_KING_DEFENDERS_MASK & WHITE_KING_DEFENCE_MASKS[static_cast<size_t>(whiteKingSquare)];
+
+	for (Square sq : whiteKingDefenders)
+		mg_eval += KING_DEFENCE_PAWN_PST[static_cast<size_t>(sq)];
+
+	Square blackKingSquare = static_cast<Square>(m_board.GetPieceBitboard(Piece::BLACK_KING));
+	Bitboard blackKingDefenders = m_board.GetPieceBitboard(Piece::BLACK_PAWN) & BLACK_KING_DEFENDERS_MASK & BLACK_KING_DEFENCE_MASKS[static_cast<size_t>(blackKingSquare)];
+
+	for (Square sq : blackKingDefenders)
+		mg_eval -= KING_DEFENCE_PAWN_PST[static_cast<size_t>(sq)];
+
+	int phase = m_board.GetPhase();
+
+	eval += mg_eval * phase;
+	eval += eg_eval * (START_PHASE - phase);
+
+	eval /= START_PHASE;
+
+	if (!m_board.IsWhiteTurn())
+		eval *= -1;
+
+	return static_cast<int16_t>(eval);
+}
+
+Move Searcher::IterativeDeepening(int8_t maxDepth) {
+	m_nodesSearched = 0;
+
+	m_killers.Reset();
+
+	int8_t depth = 1;
+	Move pvMove{ GARBAGE_MOVE };
+	int16_t bestScore = RootNegamax(depth, -MAX_SCORE, MAX_SCORE, GARBAGE_MOVE, pvMove);
+	++depth;
+
+	// If we were stopped before depth 1 found anything, fall back to any legal move rather than reporting garbage.
+	if (pvMove == GARBAGE_MOVE) {
+		MoveList moves;
+		MoveGenerationParameters params{ moves, MoveGenerationType::ALL };
+		m_moveGenerator.GenerateMoves(params);
+
+		if (moves.size() > 0)
+			pvMove = moves[0];
+	}
+
+	// Lazy SMP: odd numbered helpers run one ply ahead of the main thread so that the threads
+	// spread out over the tree rather than all searching the same nodes in lockstep.
+	if (!IsMainThread())
+		depth += m_id % 2;
+
+	while (depth <= maxDepth) {
+#if DEBUG
+		m_currentDepthNodes = 0;
+		m_quiescenceNodesSearched = 0;
+#endif
+
+		int16_t delta = ASPIRATION_WINDOW_DELTA;
+		int16_t alpha = bestScore - delta;
+		int16_t beta = bestScore + delta;
+		int16_t score;
+		Move bestMove;
+
+		while (true) {
+			score = RootNegamax(depth, alpha, beta, pvMove, bestMove);
+
+			if (m_isStopped)
+				break;
+
+			if (score <= alpha) {
+				if (score < -MATE_THRESHOLD) {
+					alpha = -MAX_SCORE;
+				} else {
+					alpha -= delta;
+					delta *= 2;
+				}
+			} else if (score >= beta) {
+				if (score > MATE_THRESHOLD) {
+					beta = MAX_SCORE;
+				} else {
+					beta += delta;
+					delta *= 2;
+				}
+			} else {
+				break;
+			}
+		}
+
+		if (m_isStopped)
+			break;
+
+		pvMove = bestMove;
+		bestScore = score;
+
+		if ((bestScore > MATE_THRESHOLD) || (bestScore < -MATE_THRESHOLD))
+			break;
+		
+		++depth;
+
+#if DEBUG
+		std::cerr << "Log: Current depth nodes: " << m_currentDepthNodes << '\n';
+		std::cerr << "Log: Current depth quiescence nodes searched: " << m_quiescenceNodesSearched << '\n';
+		std::cerr << "Log: Transpositions hit: " << m_transpositionsHit << '\n';
+		float ebf = pow(m_currentDepthNodes, (1.0f / depth));
+		std::cerr << "Log: EBF: " << ebf << "\n";
+		std::cerr << m_principleVariation;
+#endif
+	}
+
+	return pvMove;
+}
+
+int16_t Searcher::RootNegamax(int8_t depth, int16_t alpha, int16_t beta, const Move& prevBestMove, Move& bestMove) {
+#if DEBUG
+	++m_currentDepthNodes;
+	m_transpositionsHit = 0;
+	m_principleVariation.Reset();
+	std::cerr << "Log: Called root Negamax with depth " << (int) depth << '\n';
+#endif
+
+	++m_nodesSearched;
+
+	if (m_board.CheckQuietDraws())
+		return DRAW_SCORE;
+
+	MoveList moves;
+	MoveGenerationParameters params { moves, MoveGenerationType::ALL };
+	bool check = m_moveGenerator.GenerateMoves(params);
+
+	if (moves.size() == 0)
+		return check ? (-MATE_SCORE + m_board.GetMoveCount()) : DRAW_SCORE;
+
+	int8_t ply = 0;
+
+	std::array<int, MoveList::MAX_POSSIBLE_MOVES> staticScores;
+	for (int i = 0; i < moves.size(); ++i) {
+		const Move& move = moves[i];
+		if (move == prevBestMove) {
+			staticScores[i] = PV_MOVE_BASE_SCORE;
+		} else if (!move.IsCapture() && move == m_killers.GetFirst(depth))
+			staticScores[i] = FIRST_KILLER_BASE_SCORE;
+		else if (!move.IsCapture() && move == m_killers.GetSecond(depth))
+			staticScores[i] = SECOND_KILLER_BASE_SCORE;
+		else if (move.IsCapture())
+			staticScores[i] = moves.GetScore(i);
+		else
+			staticScores[i] = m_moveHistory.Get(m_board.IsWhiteTurn(), move);
+	}
+
+	int16_t bestScore = -MAX_SCORE;
+
+	for (int i = 0; i < moves.size(); ++i) {
+
+		int best = i;
+		for (int j = i + 1; j < moves.size(); ++j) {
+			if (staticScores[j] > staticScores[best])
+				best = j;
+		}
+
+		std::swap(moves[i], moves[best]);
+		std::swap(staticScores[i], staticScores[best]);
+
+		const Move& move = moves[i];
+		Undo undo = m_board.MakeMove(move);
+
+		int16_t score;
+		if (i == 0) {
+			score = -Negamax(depth-1, ply+1, -beta, -alpha);
+		} else {
+			score = -Negamax(depth-1, ply+1, -(alpha+1), -alpha);
+			if (score > alpha && score < beta)
+				score = -Negamax(depth-1, ply+1, -beta, -alpha);
+		}
+
+		m_board.UndoMove(move, undo);
+
+		if (m_isStopped)
+			return NO_SCORE;
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = move;
+
+			if (score > alpha) {
+				alpha = score;
+#if DEBUG
+				m_principleVariation.Set(ply, bestMove);
+#endif
+				if (score > beta) {
+					if (!move.IsCapture()) {
+						m_killers.Set(depth, move);
+
+						m_moveHistory.Adjust(m_board.IsWhiteTurn(), move, depth*depth);
+
+						// Penalise quiet moves tried before this
+						for (int j=0; j<i; ++j) {
+							if (!moves[j].IsCapture())
+								m_moveHistory.Adjust(m_board.IsWhiteTurn(), moves[j], -depth*depth);
+						}
+					}
+
+					return bestScore;
+				}
+			}
+		}
+	}
+
+	if (IsMainThread()) {
+		std::cerr << "Log: Negamax depth " << (int) depth << " returned an evaluation of " << bestScore << "\n";
+		std::cerr << "Log: Negamax " << (int) depth << " found the best move to be " << bestMove;
+	}
+
+	return bestScore;
+}
+
+int16_t Searcher::Negamax(int8_t depth, int8_t ply, int16_t alpha, int16_t beta, bool nmp) {
+	++m_nodesSearched;
+#if DEBUG
+	++m_currentDepthNodes;
+	m_principleVariation.Reset(ply);
+#endif
+
+	if (m_isStopped)
+		return NO_SCORE;
+
+	if (((m_nodesSearched % 2048) == 0) && (Clock::now() >= m_deadline.load())) {
+		m_isStopped = true;
+		return NO_SCORE;
+	}
+
+	// Below the root, going back to any earlier position is scored as a draw: if it was worth
+	// repeating once it's worth repeating again, and the opponent can always claim it.
+	// This has to come before the TT probe, as the TT knows nothing about how we got here.
+	if (m_board.IsRepeatPosition()) {
+		++m_repetitionsFound;
+		return DRAW_SCORE;
+	}
+
+	if (m_board.CheckQuietDraws())
+		return DRAW_SCORE;
+
+	Hash hash = m_board.GetHash();
+	TranspositionTableEntry ttEntry;
+	bool isTransposition = m_transpositionTable.GetEntry(hash, ttEntry);
+
+	// Scores that depend on a repetition on the path that stored them are only kept as MOVE_ONLY,
+	// so anything else can be trusted whatever the path here was.
+	uint64_t repetitionsFoundBefore = m_repetitionsFound;
+
+	if (isTransposition && (ttEntry.m_depth >= depth)) {
+#if DEBUG
+				++m_transpositionsHit;
+#endif
+		switch (ttEntry.GetEvaluationType()) {
+			case EvaluationType::EXACT: {
+#if DEBUG
+				m_principleVariation.Set(ply, ttEntry.m_move);
+#endif
+				if (ttEntry.m_score > MATE_THRESHOLD)
+					return ttEntry.m_score - ply;
+				if (ttEntry.m_score < -MATE_THRESHOLD)
+					return ttEntry.m_score + ply;
+				return ttEntry.m_score;
+			}
+			case EvaluationType::LOWER_BOUND: {
+				if (ttEntry.m_score >= beta)
+					return ttEntry.m_score;
+				if (ttEntry.m_score > alpha) {
+					alpha = ttEntry.m_score;
+				}
+				break;
+			}
+			case EvaluationType::UPPER_BOUND: {
+				if (ttEntry.m_score <= alpha)
+					return ttEntry.m_score;
+				beta = std::min(beta, ttEntry.m_score);
+				break;
+			}
+			case EvaluationType::MOVE_ONLY:
+				break;
+		}
+	}
+
+	MoveGenerationContext context = m_moveGenerator.GetMoveGenerationContext();
+
+	if (!m_moveGenerator.IsZugzwangLikely(context) && (depth > (NULL_MOVE_PRUNING_REDUCTION + 1)) && !nmp) {
+		Undo undo = m_board.MakeNullMove();
+		int16_t score = -Negamax(depth - NULL_MOVE_PRUNING_REDUCTION, ply+1, -beta, -(beta - 1), true);
+		m_board.UndoNullMove(undo);
+
+		if (score >= beta) {
+			return score;
+		}
+	}
+
+	MovePicker movePicker{
+		m_moveGenerator,
+		context,
+		isTransposition ? ttEntry.m_move : Move{},
+		m_killers.GetFirst(depth),
+		m_killers.GetSecond(depth),
+		m_moveHistory,
+		m_board.IsWhiteTurn()
+	};
+
+	if (depth == 0) {
+		// Quiescence never finds out that a side not in check has no moves, so stalemates have to be spotted here.
+		// Finding a single move is enough, which usually means the quiets never get generated.
+		Move anyMove;
+		if (!movePicker.Next(anyMove))
+			return m_moveGenerator.IsCheck(context) ? (-MATE_SCORE + ply) : DRAW_SCORE;
+
+		return Quiescence(ply+1, alpha, beta, true);
+	}
+
+	int16_t bestScore = -MAX_SCORE;
+	Move bestMove{ GARBAGE_MOVE };
+	EvaluationType evaluationType = EvaluationType::UPPER_BOUND;
+
+	MoveList quietsTried;
+	int numMovesTried = 0;
+
+	Move move;
+	while (movePicker.Next(move)) {
+		bool isFirstMove = (numMovesTried == 0);
+
+		// Checks that don't just hang the checking piece are searched a ply deeper, as the reply is forced and the line
+		// often ends in something decisive. The ply limit stops a long run of checks from going on forever.
+		bool givesCheck = m_moveGenerator.GivesCheck(move, context);
+		bool isExtended = givesCheck && (ply < MAX_DEPTH) && (m_moveGenerator.StaticExchangeEvaluation(move) >= 0);
+		int8_t newDepth = depth - 1 + (isExtended ? 1 : 0);
+
+		Undo undo = m_board.MakeMove(move);
+
+		// LMR
+
+		int16_t score;
+		if (isFirstMove) {
+			score = -Negamax(newDepth, ply+1, -beta, -alpha);
+		} else {
+			bool shouldLmr = (depth > 4) && (numMovesTried > 5) && !givesCheck;
+
+			int8_t lmrReduction = 0;
+			if (shouldLmr)
+				lmrReduction = 1;//(i < 6) ? 1 : (depth / 3);
+			
+			score = -Negamax(newDepth-lmrReduction, ply+1, -(alpha+1), -alpha);
+
+			if ((alpha < score) && (score < beta))
+				score = -Negamax(newDepth, ply+1, -beta, -alpha);
+		}
+
+		m_board.UndoMove(move, undo);
+
+		++numMovesTried;
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = move;
+			if (bestScore > alpha) {
+				alpha = bestScore;
+				evaluationType = EvaluationType::EXACT;
+#if DEBUG
+				m_principleVariation.Set(ply, bestMove);
+#endif
+
+				if (bestScore >= beta) {
+					evaluationType = EvaluationType::LOWER_BOUND;
+
+					if (!move.IsCapture()) {
+						m_killers.Set(depth, move);
+
+						m_moveHistory.Adjust(m_board.IsWhiteTurn(), move, depth*depth);
+
+						// Penalise quiet moves tried before this
+						for (const Move& quiet : quietsTried)
+							m_moveHistory.Adjust(m_board.IsWhiteTurn(), quiet, -depth*depth);
+					}
+
+					break;
+				}
+			}
+		}
+
+		if (!move.IsCapture())
+			quietsTried.push_back(move, QUIET_MOVE_BASE_SCORE);
+	}
+
+	if (numMovesTried == 0)
+		return m_moveGenerator.IsCheck(context) ? (-MATE_SCORE + ply) : DRAW_SCORE;
+
+	// Another path to this position may not be able to repeat, so a score that came from a repetition can't be reused.
+	if (m_repetitionsFound != repetitionsFoundBefore)
+		evaluationType = EvaluationType::MOVE_ONLY;
+
+	m_transpositionTable.SetEntry(hash, bestMove, bestScore, depth, evaluationType);
+
+	return bestScore;
+}
+
+int16_t Searcher::Quiescence(int8_t ply, int16_t alpha, int16_t beta, bool includesQuietChecks) {
+	++m_nodesSearched;
+#if DEBUG
+	++m_quiescenceNodesSearched;
+	++m_currentDepthNodes;
+#endif
+
+	if (m_isStopped)
+		return 0;
+
+	if (((m_nodesSearched % 2048) == 0) && (Clock::now() >= m_deadline.load())) {
+		m_isStopped = true;
+		return 0;
+	}
+
+	int8_t depth = 0;
+
+	Hash hash = m_board.GetHash();
+	TranspositionTableEntry ttEntry;
+	bool isTransposition = m_transpositionTable.GetEntry(hash, ttEntry);
+
+	// Any entry is at least as deep as a quiescence search, so there is no need to check its depth.
+	if (isTransposition) {
+#if DEBUG
+				++m_transpositionsHit;
+#endif
+		switch (ttEntry.GetEvaluationType()) {
+			case EvaluationType::EXACT: {
+				// When using a TT mate score, penalise it by however far away from the position is from root
+				// because if the current position is mate in N and it has taken M plies to get here, it's a mate in N+M.
+				if (ttEntry.m_score > MATE_THRESHOLD)
+					return ttEntry.m_score - ply;
+				if (ttEntry.m_score < -MATE_THRESHOLD)
+					return ttEntry.m_score + ply;
+				return ttEntry.m_score;
+			}
+			case EvaluationType::LOWER_BOUND: {
+				if (ttEntry.m_score >= beta)
+					return ttEntry.m_score;
+				alpha = std::max(alpha, ttEntry.m_score);
+				break;
+			}
+			case EvaluationType::UPPER_BOUND: {
+				if (ttEntry.m_score <= alpha)
+					return ttEntry.m_score;
+				beta = std::min(beta, ttEntry.m_score);
+				break;
+			}
+			case EvaluationType::MOVE_ONLY:
+				break;
+		}
+	}
+
+	MoveGenerationContext context = m_moveGenerator.GetMoveGenerationContext();
+	bool inCheck = m_moveGenerator.IsCheck(context);
+
+	// Standing pat assumes there is some quiet move at least as good as doing nothing, which isn't true in check.
+	// Instead every evasion gets searched, so that mates at the end of a move sequence aren't missed.
+	int16_t eval = inCheck ? -MAX_SCORE : Evaluate();
+
+	if (eval >= beta) {
+		m_transpositionTable.SetEntry(hash, Move{}, eval, depth, EvaluationType::LOWER_BOUND);
+
+		return eval;
+	}
+
+	if (eval > alpha)
+		alpha = eval;
+
+	// On its first ply, quiescence also tries quiet moves that give check, which a capture-only search is blind to.
+	bool includesQuiets = inCheck || includesQuietChecks;
+
+	MoveList moves;
+	MoveGenerationParameters params{ moves, includesQuiets ? MoveGenerationType::ALL : MoveGenerationType::CAPTURES };
+	m_moveGenerator.GenerateMoves(params, context);
+
+	if (inCheck && (moves.size() == 0))
+		return -MATE_SCORE + ply;
+
+	std::array<int, MoveList::MAX_POSSIBLE_MOVES> staticScores;
+
+	for (int i = 0; i < moves.size(); ++i) {
+		if (isTransposition && (moves[i] == ttEntry.m_move)) {
+			staticScores[i] = TT_MOVE_BASE_SCORE;
+		} else {
+			staticScores[i] = moves.GetScore(i);
+		}
+	}
+
+	int16_t bestScore = eval;
+	Move bestMove{};
+	EvaluationType evaluationType = EvaluationType::UPPER_BOUND;
+
+	for (int i = 0; i < moves.size(); ++i) {
+		int best = i;
+		for (int j = i + 1; j < moves.size(); ++j) {
+			if (staticScores[j] > staticScores[best])
+				best = j;
+		}
+
+		std::swap(moves[i], moves[best]);
+		std::swap(staticScores[i], staticScores[best]);
+
+		const Move& move = moves[i];
+
+		// Both prunings below measure a move against standing pat, so neither applies to evasions.
+		if (!inCheck) {
+			if (move.IsCapture()) {
+				int victimValue = move.IsEnPassant() ? ABSOLUTE_PIECE_VALUES[Piece::WHITE_PAWN] : ABSOLUTE_PIECE_VALUES[m_board.GetPieceAtSquare(move.GetTo())];
+
+				// Delta pruning: even winning the victim for nothing wouldn't get us back up to alpha.
+				if (!move.IsPromotion() && ((eval + victimValue + DELTA_PRUNE_MARGIN) < alpha))
+					continue;
+			} else if (!m_moveGenerator.GivesCheck(move, context)) {
+				continue;
+			}
+
+			// A move that loses material once the exchange is played out can't beat standing pat.
+			if (m_moveGenerator.StaticExchangeEvaluation(move) < 0)
+				continue;
+		}
+
+		Undo undo = m_board.MakeMove(move);
+		int16_t score = -Quiescence(ply+1, -beta, -alpha);
+		m_board.UndoMove(move, undo);
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestMove = move;
+		}
+
+		if (score >= beta) {
+			evaluationType = EvaluationType::LOWER_BOUND;
+			break;
+		}
+		
+		if (score > alpha) {
+			alpha = score;
+		}
+	}
+
+	m_transpositionTable.SetEntry(hash, bestMove, bestScore, depth, evaluationType);
+
+	return bestScore;
+}
+
+#if DEBUG
+void Searcher::PrintPv(int8_t depth) {
+	std::cerr << "PV: ";
+
+	for (int i=0; i < m_principleVariation.GetLength(); ++i) {
+		std::cerr << m_principleVariation.Get(i).ToString() << ", ";
+	}
+
+	std::cerr << "\n\n";
+}
+#endif
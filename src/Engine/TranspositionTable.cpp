@@ -2,35 +2,132 @@
 
 
 TranspositionTable::TranspositionTable() :
-	m_numEntries{ 1ULL << static_cast<int>(floor(log2(TRANSPOSITION_TABLE_RAW_NUM_ENTRIES))) },
-	m_table{}
-{
-	std::cerr << "Log: Creating transposition table with " << m_numEntries << " entries.\n";
+	m_sizeMb{TRANSPOSITION_TABLE_SIZE_MB},
+	m_numBuckets{0},
+	m_table{},
+	m_generation{0}
+{}
 
-	m_table.resize(m_numEntries);
+void TranspositionTable::Resize(size_t sizeMb) {
+	m_sizeMb = sizeMb;
+	m_numBuckets = 0;
+
+	m_table.reset();
+}
+
+void TranspositionTable::Allocate() {
+	if (m_numBuckets != 0)
+		return;
+
+	m_numBuckets = (m_sizeMb * 1024 * 1024) / sizeof(TranspositionTableBucket);
+
+	std::cerr << "Log: Creating " << m_sizeMb << " MB transposition table with " << m_numBuckets << " buckets of " << ENTRIES_PER_BUCKET << " entries.\n";
+
+	m_table = std::make_unique<TranspositionTableBucket[]>(m_numBuckets);
+	m_generation = 0;
 }
 
 void TranspositionTable::Clear() {
-	for (size_t i = 0; i < m_numEntries; ++i) {
-		m_table[i] = TranspositionTableEntry{ Move{ 0ULL, Square::NONE, Square::NONE }, 0ULL, 0, -1 };
+	for (size_t i = 0; i < m_numBuckets; ++i) {
+		for (TranspositionTableSlot& slot : m_table[i].m_slots) {
+			slot.m_keyXorData.store(0, std::memory_order_relaxed);
+			slot.m_data.store(0, std::memory_order_relaxed);
+		}
 	}
+
+	m_generation = 0;
 }
 
-const TranspositionTableEntry* TranspositionTable::GetEntry(Hash key) const {
-	size_t index = key & (m_numEntries - 1);
+bool TranspositionTable::GetEntry(Hash key, TranspositionTableEntry& entry) const {
+	for (const TranspositionTableSlot& slot : GetBucket(key).m_slots) {
+		uint64_t data = slot.m_data.load(std::memory_order_relaxed);
+		uint64_t keyXorData = slot.m_keyXorData.load(std::memory_order_relaxed);
 
-	const TranspositionTableEntry& entry = m_table[index];
+		if ((keyXorData ^ data) != key)
+			continue;
 
-	if (entry.m_key == 0)
-		return nullptr;
+		entry = UnpackEntry(data);
+		return true;
+	}
 
-	if (key == entry.m_key)
-		return &entry;
-	
-	return nullptr;
+	return false;
 }
 
-void TranspositionTable::SetEntry(Hash key, TranspositionTableEntry entry) {
-	size_t index = key & (m_numEntries - 1);
-	m_table[index] = entry;
+void TranspositionTable::SetEntry(Hash key, const Move& move, int16_t score, int8_t depth, EvaluationType evaluationType) {
+	TranspositionTableBucket& bucket = GetBucket(key);
+
+	// Prefer the slot this position already has. Otherwise evict whichever entry is worth the least,
+	// where an entry loses AGE_DEPTH_PENALTY plies of depth for every search it has gone unrefreshed.
+	// A slot torn by another thread's write just looks like some other position's entry here.
+	TranspositionTableSlot* pReplace = &bucket.m_slots[0];
+	TranspositionTableEntry replaced = UnpackEntry(pReplace->m_data.load(std::memory_order_relaxed));
+	int replaceWorth = INT32_MAX;
+	bool isSamePosition = false;
+
+	for (TranspositionTableSlot& slot : bucket.m_slots) {
+		uint64_t data = slot.m_data.load(std::memory_order_relaxed);
+		uint64_t slotKey = slot.m_keyXorData.load(std::memory_order_relaxed) ^ data;
+		TranspositionTableEntry candidate = UnpackEntry(data);
+
+		if (slotKey == key) {
+			pReplace = &slot;
+			replaced = candidate;
+			isSamePosition = true;
+			break;
+		}
+
+		int worth = (slotKey == 0) ? INT32_MIN : candidate.m_depth - AGE_DEPTH_PENALTY * GetAge(candidate);
+		if (worth < replaceWorth) {
+			pReplace = &slot;
+			replaced = candidate;
+			replaceWorth = worth;
+		}
+	}
+
+	if (isSamePosition) {
+		// Don't let a much shallower result (typically from quiescence) wipe out a deep one from this search,
+		// unless it is exact.
+		bool isDeeperResult = replaced.m_depth > depth + 2;
+		if (isDeeperResult && GetAge(replaced) == 0 && evaluationType != EvaluationType::EXACT)
+			return;
+
+		// Nor let a score that can't be used push out one that can, from at least as deep.
+		bool isUsableResult = replaced.GetEvaluationType() != EvaluationType::MOVE_ONLY;
+		if (evaluationType == EvaluationType::MOVE_ONLY && isUsableResult && replaced.m_depth >= depth && GetAge(replaced) == 0)
+			return;
+	}
+
+	Move bestMove = move;
+
+	// Keep hold of the previous best move if we don't have one of our own.
+	if (isSamePosition && move.IsNull())
+		bestMove = replaced.m_move;
+
+	uint64_t data = PackEntry(TranspositionTableEntry{
+		bestMove,
+		score,
+		depth,
+		static_cast<uint8_t>((m_generation << EVALUATION_TYPE_BITS) | static_cast<uint8_t>(evaluationType))
+	});
+
+	pReplace->m_keyXorData.store(key ^ data, std::memory_order_relaxed);
+	pReplace->m_data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t TranspositionTable::PackEntry(const TranspositionTableEntry& entry) noexcept {
+	return static_cast<uint64_t>(entry.m_move.GetData())
+		| (static_cast<uint64_t>(static_cast<uint16_t>(entry.m_score)) << 16)
+		| (static_cast<uint64_t>(static_cast<uint8_t>(entry.m_depth)) << 32)
+		| (static_cast<uint64_t>(entry.m_generationAndEvaluationType) << 40);
+}
+
+TranspositionTableEntry TranspositionTable::UnpackEntry(uint64_t data) noexcept {
+	uint16_t move = static_cast<uint16_t>(data);
+
+	return TranspositionTableEntry{
+		Move{static_cast<Square>(move & 0x3F), static_cast<Square>((move >> 6) & 0x3F), static_cast<MoveFlag>(move >> 12)},
+		static_cast<int16_t>(data >> 16),
+		static_cast<int8_t>(data >> 32),
+		static_cast<uint8_t>(data >> 40)
+	};
 }
\ No newline at end of file
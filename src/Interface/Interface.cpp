@@ -4,9 +4,16 @@ Interface::Interface() :
 	m_board{ Board() },
 	m_moveGenerator{ m_board },
 	m_player{ m_board },
-	m_commandHistory{}
+	m_commandHistory{},
+	m_searchThread{},
+	m_outputMutex{},
+	m_hasCommandFailed{false}
 {}
 
+Interface::~Interface() {
+	StopSearch();
+}
+
 void Interface::ListenForConnection() {
 	while (true) {
 		std::string input;
@@ -20,6 +27,11 @@ void Interface::ListenForConnection() {
 
 			std::cout << "id name " << ENGINE_NAME << '\n';
 			std::cout << "id author " << AUTHOR << '\n';
+			std::cout << "option name Threads type spin default " << DEFAULT_THREADS << " min 1 max " << MAX_THREADS << '\n';
+			std::cout << "option name Hash type spin default " << TRANSPOSITION_TABLE_SIZE_MB << " min 1 max " << MAX_TRANSPOSITION_TABLE_SIZE_MB << '\n';
+			std::cout << "option name Ponder type check default false\n";
+			std::cout << "option name UseNNUE type check default false\n";
+			std::cout << "option name EvalFile type string default " << DEFAULT_NNUE_FILE << '\n';
 			std::cout << "uciok\n";
 			break;
 		} else {
@@ -45,6 +57,10 @@ void Interface::ListenForCommands() {
 }
 
 bool Interface::ProcessCommand(std::string input) {
+	// Only these commands are allowed to arrive mid-search. Everything else waits for the search to finish first.
+	if (input != "isready" && input != "stop" && input != "quit" && input != "ponderhit")
+		WaitForSearch();
+
 	if (input == "show") {
 		std::cout << m_board;
 		return true;
@@ -52,7 +68,7 @@ bool Interface::ProcessCommand(std::string input) {
 
 	if (input == "moves") {
 		MoveList moves;
-		MoveGenerationParameters params { moves, false };
+		MoveGenerationParameters params { moves, MoveGenerationType::ALL };
 		m_moveGenerator.GenerateMoves(params);
 		for (const Move& m : moves) {
 			std::cout << m;
@@ -62,7 +78,7 @@ bool Interface::ProcessCommand(std::string input) {
 
 	if (input == "captures") {
 		MoveList moves;
-		MoveGenerationParameters params { moves, true };
+		MoveGenerationParameters params { moves, MoveGenerationType::CAPTURES };
 		m_moveGenerator.GenerateMoves(params);
 		for (const Move& m : moves) {
 			std::cout << m;
@@ -93,6 +109,7 @@ bool Interface::ProcessCommand(std::string input) {
 	}
 
 	if (input == "quit") {
+		StopSearch();
 		FlushCommandHistory();
 		time_t connectionTime = time(nullptr);
 		std::cerr << "Log: Connection closed at " << ctime(&connectionTime) << '\n';
@@ -100,22 +117,29 @@ bool Interface::ProcessCommand(std::string input) {
 	}
 
 	if (input == "ucinewgame") {
-		m_player.ClearTranspositionTable();
+		m_player.NewGame();
 		return true;
 	}
 
 	if (input == "isready") {
+		// GUIs send isready once the options are set and before the first go, so that's the time to
+		// allocate the hash. A search thread that hasn't been joined yet means the table is already in use.
+		if (!m_searchThread.joinable())
+			m_player.AllocateTranspositionTable();
+
+		std::lock_guard<std::mutex> lock(m_outputMutex);
 		std::cout << "readyok\n" << std::flush;
 		return true;
 	}
 
 	if (input == "stop") {
-		std::cerr << "Log: stop called. Currently does nothing\n";
+		StopSearch();
 		return true;
 	}
 
 	if (input == "ponderhit") {
-		std::cerr << "Log: ponderhit called. Currently does nothing\n";
+		m_player.PonderHit();
+		return true;
 	}
 
 	std::istringstream tokenStream(input);
@@ -141,6 +165,42 @@ bool Interface::ProcessCommand(std::string input) {
 		return true;
 	}
 
+	if (token == "bench") {
+		if (!Bench(tokenStream))
+			std::cerr << "Log: Bench failed\n";
+		return true;
+	}
+
+	if (token == "perftsuite") {
+		if (!PerftSuite(tokenStream)) {
+			std::cerr << "Log: Perft suite failed\n";
+			m_hasCommandFailed = true;
+		}
+		return true;
+	}
+
+	if (token == "sliderbench") {
+		if (!SliderBench(tokenStream)) {
+			std::cerr << "Log: Slider bench failed\n";
+			m_hasCommandFailed = true;
+		}
+		return true;
+	}
+
+	if (token == "nnuecheck") {
+		if (!NnueCheck(tokenStream)) {
+			std::cerr << "Log: NNUE check failed\n";
+			m_hasCommandFailed = true;
+		}
+		return true;
+	}
+
+	if (token == "setoption") {
+		if (!SetOption(tokenStream))
+			std::cerr << "Log: Setoption failed\n";
+		return true;
+	}
+
 	std::cerr << "Log: input " << input << " fell through...\n";
 	return true;
 }
@@ -172,7 +232,7 @@ bool Interface::StartPosition(std::istringstream& tokenStream) {
 
 	while (tokenStream >> token) {
 		MoveList moves;
-		MoveGenerationParameters params { moves, false };
+		MoveGenerationParameters params { moves, MoveGenerationType::ALL };
 		m_moveGenerator.GenerateMoves(params);
 
 		bool foundMove = false;
@@ -201,6 +261,8 @@ bool Interface::Go(std::istringstream& tokenStream) {
 	int binc = -1;
 	int movestogo = -1;
 	int movetime = -1;
+	bool infinite = false;
+	bool ponder = false;
 
 	std::string token;
 	
@@ -212,18 +274,44 @@ bool Interface::Go(std::istringstream& tokenStream) {
 		else if (token == "binc") tokenStream >> binc;
 		else if (token == "movestogo") tokenStream >> movestogo;
 		else if (token == "movetime") tokenStream >> movetime;
+		else if (token == "infinite") infinite = true;
+		else if (token == "ponder") ponder = true;
 		else {
 			std::cout << "Error: Unrecognised option {" << token << "}.\n";
 			return false;
 		}
 	}
 
-	Move bestMove = m_player.Go(depth, wtime, btime, winc, binc, movestogo, movetime);
+	// Clear the stop flag before launching so that a stop arriving straight after go is never lost.
+	m_player.ClearStop();
+	m_player.SetPondering(ponder);
+	m_searchThread = std::thread(&Interface::Search, this, depth, wtime, btime, winc, binc, movestogo, movetime, infinite);
+
+	return true;
+}
+
+void Interface::Search(int depth, int wtime, int btime, int winc, int binc, int movestogo, int movetime, bool infinite) {
+	Move bestMove = m_player.Go(depth, wtime, btime, winc, binc, movestogo, movetime, infinite);
+
+	Move ponderMove;
+	bool hasPonderMove = m_player.GetPonderMove(bestMove, ponderMove);
 
-	std::cout << "bestmove " << bestMove.ToString() << '\n' << std::flush;
+	std::lock_guard<std::mutex> lock(m_outputMutex);
+	std::cout << "bestmove " << bestMove.ToString();
+	if (hasPonderMove)
+		std::cout << " ponder " << ponderMove.ToString();
+	std::cout << '\n' << std::flush;
 	std::cerr << '\n';
+}
 
-	return true;
+void Interface::StopSearch() {
+	m_player.Stop();
+	WaitForSearch();
+}
+
+void Interface::WaitForSearch() {
+	if (m_searchThread.joinable())
+		m_searchThread.join();
 }
 
 bool Interface::Perft(std::istringstream& tokenStream) {
@@ -238,12 +326,400 @@ bool Interface::Perft(std::istringstream& tokenStream) {
 		return false;
 	}
 
-	int totalMoves = m_player.RootPerft(depth);
-	std::cout << "Total: " << totalMoves << '\n' << std::flush;
+	int threads = static_cast<int>(m_player.GetThreads());
+	int cacheSizeMb = 0;
+	bool isBulkCounting = false;
+
+	std::string token;
+	while (tokenStream >> token) {
+		if (token == "threads") {
+			if (!(tokenStream >> threads) || threads < 1 || threads > MAX_THREADS) {
+				std::cout << "Error: Threads must be between 1 and " << MAX_THREADS << ".\n";
+				return false;
+			}
+		} else if (token == "bulk") {
+			isBulkCounting = true;
+		} else if (token == "hash") {
+			if (!(tokenStream >> cacheSizeMb) || cacheSizeMb < 0 || cacheSizeMb > MAX_TRANSPOSITION_TABLE_SIZE_MB) {
+				std::cout << "Error: Perft hash must be between 0 and " << MAX_TRANSPOSITION_TABLE_SIZE_MB << " MB.\n";
+				return false;
+			}
+		} else {
+			std::cout << "Error: Unrecognised option {" << token << "}.\n";
+			return false;
+		}
+	}
+
+	Moment startTime = Clock::now();
+	PerftStatistics statistics;
+	PerftParameters params{ static_cast<size_t>(threads), static_cast<size_t>(cacheSizeMb), isBulkCounting, true };
+	uint64_t totalMoves = m_player.RootPerft(depth, params, statistics);
+	auto perftTimeMs = std::max<int64_t>(1, std::chrono::duration_cast<ms>(Clock::now() - startTime).count());
+
+	std::cout << "Total: " << totalMoves << '\n';
+	std::cout << "Time (ms): " << perftTimeMs << '\n';
+	std::cout << "Nodes/second: " << totalMoves * 1000 / perftTimeMs << '\n';
+
+	if (cacheSizeMb > 0) {
+		double hitRate = (statistics.m_cacheProbes > 0) ? (100.0 * statistics.m_cacheHits / statistics.m_cacheProbes) : 0.0;
+		std::cout << "Cache hits: " << statistics.m_cacheHits << '/' << statistics.m_cacheProbes << " (" << hitRate << "%)\n";
+	}
+
+	std::cout << std::flush;
 
 	return true;
 }
 
+bool Interface::Bench(std::istringstream& tokenStream) {
+	int depth = BENCH_DEPTH;
+	int threads = BENCH_THREADS;
+	int hashMb = BENCH_HASH_MB;
+
+	// All three are optional, but each one given must be valid.
+	if (!(tokenStream >> depth))
+		depth = BENCH_DEPTH;
+	else if (!(tokenStream >> threads))
+		threads = BENCH_THREADS;
+	else if (!(tokenStream >> hashMb))
+		hashMb = BENCH_HASH_MB;
+
+	if (depth < 1 || depth > MAX_DEPTH) {
+		std::cout << "Error: Bench depth must be between 1 and " << MAX_DEPTH << ".\n";
+		return false;
+	}
+
+	if (threads < 1 || threads > MAX_THREADS) {
+		std::cout << "Error: Threads must be between 1 and " << MAX_THREADS << ".\n";
+		return false;
+	}
+
+	if (hashMb < 1 || hashMb > MAX_TRANSPOSITION_TABLE_SIZE_MB) {
+		std::cout << "Error: Hash must be between 1 and " << MAX_TRANSPOSITION_TABLE_SIZE_MB << " MB.\n";
+		return false;
+	}
+
+	StopSearch();
+
+	// Put everything back afterwards so that a bench in the middle of a session doesn't change it.
+	Board board = m_board;
+	size_t oldThreads = m_player.GetThreads();
+	size_t oldHashMb = m_player.GetTranspositionTableSize();
+
+	m_player.SetThreads(threads);
+	m_player.SetTranspositionTableSize(hashMb);
+	m_player.AllocateTranspositionTable();
+
+	// The signature folds in each position's node count and best move, so any change to what the
+	// search does shows up in it, while a pure speed change leaves it alone. It is only reproducible with one thread.
+	uint64_t signature = 14695981039346656037ULL;
+	uint64_t totalNodes = 0;
+	Moment startTime = Clock::now();
+
+	for (size_t i = 0; i < BENCH_POSITIONS.size(); ++i) {
+		std::istringstream fenStream{std::string{BENCH_POSITIONS[i]}};
+		m_board.SetUpFenPosition(fenStream);
+
+		m_player.NewGame();
+		m_player.ClearStop();
+		m_player.SetPondering(false);
+
+		Move bestMove = m_player.Go(depth, -1, -1, -1, -1, -1, -1, false);
+		uint64_t nodes = m_player.GetNodesSearched();
+
+		totalNodes += nodes;
+		signature = (signature ^ nodes) * 1099511628211ULL;
+		signature = (signature ^ bestMove.GetData()) * 1099511628211ULL;
+
+		std::cout << "Position " << (i + 1) << '/' << BENCH_POSITIONS.size() << ": " << bestMove.ToString() << ' ' << nodes << " nodes\n";
+	}
+
+	auto benchTimeMs = std::max<int64_t>(1, std::chrono::duration_cast<ms>(Clock::now() - startTime).count());
+
+	std::cout << "\n";
+	std::cout << "Total time (ms) : " << benchTimeMs << '\n';
+	std::cout << "Nodes searched  : " << totalNodes << '\n';
+	std::cout << "Nodes/second    : " << totalNodes * 1000 / benchTimeMs << '\n';
+	std::cout << "Signature       : " << std::hex << signature << std::dec << '\n' << std::flush;
+
+	m_board = board;
+	m_player.SetThreads(oldThreads);
+	m_player.SetTranspositionTableSize(oldHashMb);
+
+	return true;
+}
+
+bool Interface::PerftSuite(std::istringstream& tokenStream) {
+	int depth = PERFT_SUITE_DEPTH;
+	if (!(tokenStream >> depth))
+		depth = PERFT_SUITE_DEPTH;
+
+	if (depth < 1 || depth > PERFT_SUITE_MAX_DEPTH) {
+		std::cout << "Error: Perft suite depth must be between 1 and " << PERFT_SUITE_MAX_DEPTH << ".\n";
+		return false;
+	}
+
+	StopSearch();
+
+	Board board = m_board;
+
+	// Plain perft on one thread with no cache, so that the timings measure move generation and nothing else.
+	PerftParameters params{ 1, 0, false, false };
+	PerftStatistics statistics;
+
+	uint64_t totalNodes = 0;
+	int64_t totalTimeUs = 0;
+	size_t numFailed = 0;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (const PerftSuitePosition& position : PERFT_SUITE_POSITIONS) {
+		// Some counts are only known to a shallower depth, so those positions stop there.
+		int positionDepth = depth;
+		while (position.m_counts[positionDepth - 1] == 0)
+			--positionDepth;
+
+		std::istringstream fenStream{std::string{position.m_fen}};
+		m_board.SetUpFenPosition(fenStream);
+
+		Moment startTime = Clock::now();
+		uint64_t nodes = m_player.RootPerft(positionDepth, params, statistics);
+		int64_t timeUs = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count());
+
+		uint64_t expected = position.m_counts[positionDepth - 1];
+		bool isCorrect = nodes == expected;
+		if (!isCorrect)
+			++numFailed;
+
+		totalNodes += nodes;
+		totalTimeUs += timeUs;
+
+		std::cout << (isCorrect ? "OK   " : "FAIL ") << position.m_name << " (depth " << positionDepth << "): " << nodes;
+		if (!isCorrect)
+			std::cout << ", expected " << expected;
+		std::cout << ", " << static_cast<double>(nodes) / timeUs << " Mnodes/s\n";
+	}
+
+	std::cout << "\n";
+	std::cout << "Positions failed: " << numFailed << '/' << PERFT_SUITE_POSITIONS.size() << '\n';
+	std::cout << "Total time (ms) : " << totalTimeUs / 1000 << '\n';
+	std::cout << "Nodes           : " << totalNodes << '\n';
+	std::cout << "Mnodes/second   : " << static_cast<double>(totalNodes) / std::max<int64_t>(1, totalTimeUs) << '\n';
+	std::cout << std::defaultfloat << std::setprecision(6) << std::flush;
+
+	m_board = board;
+
+	return numFailed == 0;
+}
+
+bool Interface::SliderBench(std::istringstream& tokenStream) {
+	int64_t numLookups = SLIDER_BENCH_LOOKUPS;
+	if (!(tokenStream >> numLookups))
+		numLookups = SLIDER_BENCH_LOOKUPS;
+
+	if (numLookups < 1) {
+		std::cout << "Error: Slider bench needs at least one lookup.\n";
+		return false;
+	}
+
+	// The same squares and occupancies for every backend. ANDing two random boards gives about 16 pieces, which
+	// is closer to a real position than a random board is.
+	std::mt19937_64 rng{};
+	std::vector<std::pair<Square, Bitboard>> inputs(1 << 16);
+	for (std::pair<Square, Bitboard>& input : inputs)
+		input = { static_cast<Square>(rng() % static_cast<size_t>(Square::COUNT)), Bitboard{ rng() & rng() } };
+
+	SliderBackend selectedBackend = MagicBitboardHelper::GetInstance().GetSliderBackend();
+	uint64_t expectedChecksum = 0;
+	bool isFirstBackend = true;
+	bool hasMismatch = false;
+
+	std::cout << std::fixed << std::setprecision(2);
+
+	for (size_t i = 0; i < static_cast<size_t>(SliderBackend::COUNT); ++i) {
+		SliderBackend backend = static_cast<SliderBackend>(i);
+		std::cout << SLIDER_BACKEND_NAMES[i] << (backend == selectedBackend ? " (selected)" : "") << ": ";
+
+		if (!MagicBitboardHelper::IsSliderBackendSupported(backend)) {
+			std::cout << "not supported on this CPU\n";
+			continue;
+		}
+
+		std::unique_ptr<const MagicBitboardHelper> helper = MagicBitboardHelper::Create(backend);
+
+		// Summing the attacks keeps the lookups from being optimised away and checks the backends agree.
+		uint64_t checksum = 0;
+		Moment startTime = Clock::now();
+
+		for (int64_t j = 0; j < numLookups; ++j) {
+			const auto& [square, occupancy] = inputs[j & (inputs.size() - 1)];
+			checksum += helper->GetOrthogonalAttacks(square, GetOrthogonalOccupancyMask(square) & occupancy).GetBoard();
+			checksum += helper->GetDiagonalAttacks(square, GetDiagonalOccupancyMask(square) & occupancy).GetBoard();
+		}
+
+		int64_t timeUs = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - startTime).count());
+
+		std::cout << 2.0 * numLookups / timeUs << " Mlookups/s";
+
+		if (isFirstBackend) {
+			expectedChecksum = checksum;
+			isFirstBackend = false;
+		} else if (checksum != expectedChecksum) {
+			std::cout << ", attacks differ from " << SLIDER_BACKEND_NAMES[0];
+			hasMismatch = true;
+		}
+
+		std::cout << '\n';
+	}
+
+	std::cout << std::defaultfloat << std::setprecision(6) << std::flush;
+
+	if (hasMismatch) {
+		std::cout << "Error: Slider backends gave different attacks.\n";
+		return false;
+	}
+
+	return true;
+}
+
+bool Interface::NnueCheck(std::istringstream& tokenStream) {
+	// Write the network out in the file layout, so that the check covers loading and the feature numbering as well.
+	std::vector<int16_t> inputWeights(NNUE_INPUT_SIZE * NNUE_HIDDEN_SIZE, 0);
+	for (size_t piece = 0; piece < Piece::NUM_PIECES; ++piece) {
+		bool isOurs = piece < Piece::BLACK_PAWN;
+		int16_t material = NNUE_CHECK_UNIT_WEIGHT * NNUE_CHECK_MATERIAL[piece % Piece::BLACK_PAWN];
+
+		for (size_t square = 0; square < static_cast<size_t>(Square::COUNT); ++square) {
+			int16_t* row = &inputWeights[(piece * static_cast<size_t>(Square::COUNT) + square) * NNUE_HIDDEN_SIZE];
+			row[isOurs ? 0 : 1] = material;
+
+			// Square 0 is h1, so the rank is the square over 8 and pawns start on rank index 1.
+			if (piece == Piece::WHITE_PAWN)
+				row[2] = NNUE_CHECK_UNIT_WEIGHT * std::max(0, static_cast<int>(square / 8) - 1);
+		}
+	}
+
+	std::array<int16_t, NNUE_HIDDEN_SIZE> inputBiases{};
+	std::array<int16_t, 2 * NNUE_HIDDEN_SIZE> outputWeights{};
+	outputWeights[0] = NNUE_CHECK_OUTPUT_WEIGHT;
+	outputWeights[1] = -NNUE_CHECK_OUTPUT_WEIGHT;
+	outputWeights[2] = NNUE_CHECK_OUTPUT_WEIGHT;
+	outputWeights[NNUE_HIDDEN_SIZE + 0] = -NNUE_CHECK_OUTPUT_WEIGHT;
+	outputWeights[NNUE_HIDDEN_SIZE + 1] = NNUE_CHECK_OUTPUT_WEIGHT;
+	outputWeights[NNUE_HIDDEN_SIZE + 2] = -NNUE_CHECK_OUTPUT_WEIGHT;
+	int16_t outputBias = NNUE_CHECK_OUTPUT_BIAS;
+
+	std::stringstream file;
+	file.write(reinterpret_cast<const char*>(inputWeights.data()), inputWeights.size() * sizeof(int16_t));
+	file.write(reinterpret_cast<const char*>(inputBiases.data()), inputBiases.size() * sizeof(int16_t));
+	file.write(reinterpret_cast<const char*>(outputWeights.data()), outputWeights.size() * sizeof(int16_t));
+	file.write(reinterpret_cast<const char*>(&outputBias), sizeof(int16_t));
+
+	NnueNetwork network;
+	if (!network.Load(file, "nnuecheck")) {
+		std::cout << "Error: Could not load the check network.\n";
+		return false;
+	}
+
+	Board board;
+	board.SetNetwork(&network);
+
+	size_t numFailed = 0;
+
+	for (const NnueCheckPosition& position : NNUE_CHECK_POSITIONS) {
+		std::istringstream fenStream{std::string{position.m_fen}};
+		board.SetUpFenPosition(fenStream);
+
+		int eval = network.Evaluate(board.GetAccumulator(), board.IsWhiteTurn());
+		bool isCorrect = eval == position.m_eval;
+		if (!isCorrect)
+			++numFailed;
+
+		std::cout << (isCorrect ? "OK   " : "FAIL ") << position.m_name << ": " << eval;
+		if (!isCorrect)
+			std::cout << ", expected " << position.m_eval;
+		std::cout << '\n';
+	}
+
+	std::cout << "\n";
+	std::cout << "Positions failed: " << numFailed << '/' << NNUE_CHECK_POSITIONS.size() << '\n' << std::flush;
+
+	return numFailed == 0;
+}
+
+bool Interface::SetOption(std::istringstream& tokenStream) {
+	std::string token;
+	if (!(tokenStream >> token) || token != "name") {
+		std::cout << "Error: Expected option name.\n";
+		return false;
+	}
+
+	std::string name;
+	if (!(tokenStream >> name)) {
+		std::cout << "Error: Expected option name.\n";
+		return false;
+	}
+
+	if (!(tokenStream >> token) || token != "value") {
+		std::cout << "Error: Expected option value.\n";
+		return false;
+	}
+
+	if (name == "Threads") {
+		int threads = -1;
+		if (!(tokenStream >> threads) || threads < 1 || threads > MAX_THREADS) {
+			std::cout << "Error: Threads must be between 1 and " << MAX_THREADS << ".\n";
+			return false;
+		}
+
+		m_player.SetThreads(threads);
+		return true;
+	}
+
+	if (name == "Hash") {
+		int sizeMb = -1;
+		if (!(tokenStream >> sizeMb) || sizeMb < 1 || sizeMb > MAX_TRANSPOSITION_TABLE_SIZE_MB) {
+			std::cout << "Error: Hash must be between 1 and " << MAX_TRANSPOSITION_TABLE_SIZE_MB << " MB.\n";
+			return false;
+		}
+
+		m_player.SetTranspositionTableSize(sizeMb);
+		return true;
+	}
+
+	if (name == "Ponder") {
+		// Nothing to configure: the GUI decides when to send go ponder, and pondering is always supported.
+		std::string value;
+		tokenStream >> value;
+		return value == "true" || value == "false";
+	}
+
+	if (name == "UseNNUE") {
+		std::string value;
+		tokenStream >> value;
+		if (value != "true" && value != "false") {
+			std::cout << "Error: UseNNUE must be true or false.\n";
+			return false;
+		}
+
+		return m_player.SetUseNetwork(value == "true");
+	}
+
+	if (name == "EvalFile") {
+		// The path may contain spaces, so it is the rest of the line.
+		std::string path;
+		std::getline(tokenStream >> std::ws, path);
+		if (path.empty()) {
+			std::cout << "Error: Expected a network file.\n";
+			return false;
+		}
+
+		return m_player.SetNetworkFile(path);
+	}
+
+	std::cout << "Error: Unrecognised option {" << name << "}.\n";
+	return false;
+}
+
 void Interface::FlushCommandHistory() {
 	if (m_commandHistory.empty())
 		return;
@@ -2,9 +2,19 @@
 
 #include "Interface/Interface.h"
 
-int main() {
+int main(int argc, char* argv[]) {
 	Interface interface;
 
+	// Anything on the command line is run as a single command instead of talking UCI, e.g. "main perftsuite 5".
+	if (argc > 1) {
+		std::string command = argv[1];
+		for (int i = 2; i < argc; ++i)
+			command += std::string(" ") + argv[i];
+
+		interface.ProcessCommand(command);
+		return interface.HasCommandFailed() ? 1 : 0;
+	}
+
 	interface.ListenForConnection();
 	interface.ListenForCommands();
 
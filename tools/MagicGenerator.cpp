@@ -0,0 +1,9 @@
+#include "Engine/MagicBitboardHelper.h"
+
+// Prints a fresh set of rook and bishop magics for the per-square shifts in MagicBitboardHelper.h.
+// Paste the output over ORTHOGONAL_MAGICS and DIAGONAL_MAGICS.
+int main() {
+	MagicBitboardHelper::GenerateMagics();
+
+	return 0;
+}